@@ -0,0 +1,571 @@
+#include "abacus.h"
+#include "glouvain.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+
+namespace {
+
+// bit-vector tidsets of W words
+
+size_t
+intersection_size(
+    const uint64_t* s1,
+    const uint64_t* s2,
+    size_t W
+)
+{
+    size_t res = 0;
+
+    for (size_t w = 0; w < W; w++)
+    {
+        res += __builtin_popcountll(s1[w] & s2[w]);
+    }
+
+    return res;
+}
+
+void
+intersect(
+    const uint64_t* s1,
+    const uint64_t* s2,
+    uint64_t* res,
+    size_t W
+)
+{
+    for (size_t w = 0; w < W; w++)
+    {
+        res[w] = s1[w] & s2[w];
+    }
+}
+
+bool
+contains(
+    const uint64_t* s1,
+    const uint64_t* s2,
+    size_t W
+)
+{
+    for (size_t w = 0; w < W; w++)
+    {
+        if ((s1[w] & s2[w]) != s2[w])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// budget shared by the threads
+class Budget
+{
+  public:
+
+    explicit
+    Budget(
+        const MiningBudget& budget
+    ) : budget_(budget), found_(0), stop_(false), start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    bool
+    stopped(
+    ) const
+    {
+        return stop_.load(std::memory_order_relaxed);
+    }
+
+    // checks the time limit
+    bool
+    check_time(
+    )
+    {
+        if (budget_.max_seconds > 0 &&
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count() > budget_.max_seconds)
+        {
+            stop_.store(true, std::memory_order_relaxed);
+        }
+
+        return stopped();
+    }
+
+    // reserves one more itemset, if the limit allows it
+    bool
+    reserve(
+    )
+    {
+        if (budget_.max_itemsets == 0)
+        {
+            return true;
+        }
+
+        size_t num = found_.fetch_add(1, std::memory_order_relaxed);
+
+        if (num + 1 >= budget_.max_itemsets)
+        {
+            stop_.store(true, std::memory_order_relaxed);
+        }
+
+        return num < budget_.max_itemsets;
+    }
+
+  private:
+
+    MiningBudget budget_;
+    std::atomic<size_t> found_;
+    std::atomic<bool> stop_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// itemsets found in one branch
+struct Found
+{
+    std::vector<size_t> item_end;
+    std::vector<int> item;
+    std::vector<size_t> tid_end;
+    std::vector<int> tid;
+};
+
+// search of the closed itemsets containing one item, on the transactions containing it
+class Miner
+{
+  public:
+
+    Miner(
+        const std::vector<size_t>& start,
+        const std::vector<int>& item,
+        size_t num_items,
+        size_t min_support,
+        size_t min_size,
+        Budget& budget
+    ) : start_(start), item_(item), min_support_(min_support), min_size_(min_size),
+        budget_(budget), local_(num_items, -1), support_(num_items, 0)
+    {
+    }
+
+    void
+    run(
+        int root,
+        const std::vector<int>& tids,
+        const std::vector<int>& closure,
+        Found& found
+    )
+    {
+        found_ = &found;
+        tids_ = &tids;
+        size_t n = tids.size();
+        W_ = (n + 63) / 64;
+
+        // frequent items of the local transactions, in order
+
+        std::vector<int> touched;
+
+        for (auto t: tids)
+        {
+            for (size_t p = start_[t]; p < start_[t+1]; p++)
+            {
+                if (support_[item_[p]]++ == 0)
+                {
+                    touched.push_back(item_[p]);
+                }
+            }
+        }
+
+        std::sort(touched.begin(), touched.end());
+        items_.clear();
+
+        for (auto i: touched)
+        {
+            if (support_[i] >= min_support_)
+            {
+                local_[i] = items_.size();
+                items_.push_back(i);
+            }
+
+            support_[i] = 0;
+        }
+
+        // local tidsets, and local items of each local transaction
+
+        tidsets_.assign(items_.size() * W_, 0);
+        t_start_.assign(1, 0);
+        t_item_.clear();
+
+        for (size_t t = 0; t < n; t++)
+        {
+            for (size_t p = start_[tids[t]]; p < start_[tids[t]+1]; p++)
+            {
+                int j = local_[item_[p]];
+
+                if (j >= 0)
+                {
+                    tidsets_[j * W_ + t / 64] |= (uint64_t)1 << (t % 64);
+                    t_item_.push_back(j);
+                }
+            }
+
+            t_start_.push_back(t_item_.size());
+        }
+
+        in_set_.assign(items_.size(), 0);
+
+        for (auto i: closure)
+        {
+            if (local_[i] >= 0)
+            {
+                in_set_[local_[i]] = 1;
+            }
+        }
+
+        if (levels_.empty())
+        {
+            levels_.emplace_back();
+        }
+
+        levels_[0].assign(W_, 0);
+
+        for (size_t t = 0; t < n; t++)
+        {
+            levels_[0][t / 64] |= (uint64_t)1 << (t % 64);
+        }
+
+        set_.assign(closure.begin(), closure.end());
+        extend(0, local_[root]);
+
+        for (auto i: items_)
+        {
+            local_[i] = -1;
+        }
+    }
+
+  private:
+
+    // extends the closed itemset in set_ (tidset in levels_[depth]) with local item j
+    void
+    extend(
+        size_t depth,
+        int j
+    )
+    {
+        if (budget_.stopped() || (++nodes_ % 1024 == 0 && budget_.check_time()))
+        {
+            return;
+        }
+
+        if (levels_.size() == depth + 1)
+        {
+            levels_.emplace_back();
+        }
+
+        // references to the elements of a deque are not invalidated by push_back
+        auto& next = levels_[depth + 1];
+        next.resize(W_);
+        intersect(levels_[depth].data(), &tidsets_[j * W_], next.data(), W_);
+
+        // closure: the items of the first transaction contained in all the others;
+        // it is prefix-preserving if it adds no item smaller than j
+        size_t w = 0;
+
+        while (next[w] == 0)
+        {
+            w++;
+        }
+
+        size_t first = w * 64 + __builtin_ctzll(next[w]);
+
+        std::vector<int> added;
+
+        for (size_t p = t_start_[first]; p < t_start_[first+1]; p++)
+        {
+            int i = t_item_[p];
+
+            if (in_set_[i] || !contains(&tidsets_[i * W_], next.data(), W_))
+            {
+                continue;
+            }
+
+            if (i < j)
+            {
+                return;
+            }
+
+            added.push_back(i);
+        }
+
+        for (auto i: added)
+        {
+            in_set_[i] = 1;
+            set_.push_back(items_[i]);
+        }
+
+        if (set_.size() >= min_size_ && budget_.reserve())
+        {
+            report(next.data());
+        }
+
+        for (size_t i = j + 1; i < items_.size() && !budget_.stopped(); i++)
+        {
+            if (in_set_[i])
+            {
+                continue;
+            }
+
+            if (intersection_size(next.data(), &tidsets_[i * W_], W_) >= min_support_)
+            {
+                extend(depth + 1, i);
+            }
+        }
+
+        for (auto i: added)
+        {
+            in_set_[i] = 0;
+        }
+
+        set_.resize(set_.size() - added.size());
+    }
+
+    void
+    report(
+        const uint64_t* tidset
+    )
+    {
+        size_t first = found_->item.size();
+        found_->item.insert(found_->item.end(), set_.begin(), set_.end());
+        std::sort(found_->item.begin() + first, found_->item.end());
+        found_->item_end.push_back(found_->item.size());
+
+        for (size_t t = 0; t < tids_->size(); t++)
+        {
+            if (tidset[t / 64] >> (t % 64) & 1)
+            {
+                found_->tid.push_back((*tids_)[t]);
+            }
+        }
+
+        found_->tid_end.push_back(found_->tid.size());
+    }
+
+    const std::vector<size_t>& start_;
+    const std::vector<int>& item_;
+    size_t min_support_;
+    size_t min_size_;
+    Budget& budget_;
+
+    // local id of each item, or -1, and support among the local transactions
+    std::vector<int> local_;
+    std::vector<size_t> support_;
+
+    // local items, their tidsets, and the local items of each local transaction
+    size_t W_;
+    std::vector<int> items_;
+    std::vector<uint64_t> tidsets_;
+    std::vector<size_t> t_start_;
+    std::vector<int> t_item_;
+
+    // current itemset (global ids) and its local items
+    std::vector<int> set_;
+    std::vector<char> in_set_;
+
+    // tidset at each depth
+    std::deque<std::vector<uint64_t>> levels_;
+    size_t nodes_ = 0;
+    const std::vector<int>* tids_;
+    Found* found_;
+};
+
+}
+
+ClosedItemsets
+closed_itemsets(
+    const std::vector<size_t>& start,
+    const std::vector<int>& item,
+    size_t num_items,
+    size_t min_support,
+    size_t min_size,
+    const MiningBudget& budget,
+    size_t num_threads
+)
+{
+    size_t n = start.size() - 1;
+    min_support = std::max<size_t>(min_support, 1);
+
+    // transactions containing each item
+    std::vector<size_t> i_start(num_items + 1, 0);
+
+    for (auto i: item)
+    {
+        i_start[i + 1]++;
+    }
+
+    for (size_t i = 0; i < num_items; i++)
+    {
+        i_start[i+1] += i_start[i];
+    }
+
+    std::vector<int> i_tid(item.size());
+    std::vector<size_t> pos(i_start.begin(), i_start.end() - 1);
+
+    for (size_t t = 0; t < n; t++)
+    {
+        for (size_t p = start[t]; p < start[t+1]; p++)
+        {
+            i_tid[pos[item[p]]++] = t;
+        }
+    }
+
+    // closure of the empty itemset: the items in all the transactions
+    std::vector<int> closure;
+
+    for (size_t i = 0; i < num_items; i++)
+    {
+        if (i_start[i+1] - i_start[i] == n)
+        {
+            closure.push_back(i);
+        }
+    }
+
+    Budget shared(budget);
+    std::vector<Found> found(num_items + 1);
+
+    if (n >= min_support && !closure.empty() && closure.size() >= min_size && shared.reserve())
+    {
+        found[0].item = closure;
+        found[0].item_end.push_back(closure.size());
+
+        for (size_t t = 0; t < n; t++)
+        {
+            found[0].tid.push_back(t);
+        }
+
+        found[0].tid_end.push_back(n);
+    }
+
+    std::vector<std::unique_ptr<Miner>> workspaces(num_threads);
+
+    parallel_for(num_items, num_threads, [&](size_t i, size_t t)
+    {
+        size_t support = i_start[i+1] - i_start[i];
+
+        if (support < min_support || support == n || shared.stopped())
+        {
+            return;
+        }
+
+        if (!workspaces[t])
+        {
+            workspaces[t].reset(new Miner(start, item, num_items, min_support, min_size, shared));
+        }
+
+        std::vector<int> tids(i_tid.begin() + i_start[i], i_tid.begin() + i_start[i+1]);
+        workspaces[t]->run(i, tids, closure, found[i + 1]);
+    });
+
+    ClosedItemsets res;
+    res.item_start.assign(1, 0);
+    res.tid_start.assign(1, 0);
+
+    for (auto& f: found)
+    {
+        for (size_t k = 0; k < f.item_end.size(); k++)
+        {
+            res.item_start.push_back(res.item.size() + f.item_end[k]);
+            res.tid_start.push_back(res.tid.size() + f.tid_end[k]);
+        }
+
+        res.item.insert(res.item.end(), f.item.begin(), f.item.end());
+        res.tid.insert(res.tid.end(), f.tid.begin(), f.tid.end());
+    }
+
+    res.complete = !shared.stopped();
+    return res;
+}
+
+AbacusCommunities
+abacus(
+    const MLIndex& idx,
+    size_t min_actors,
+    size_t min_layers,
+    const MiningBudget& budget,
+    size_t num_threads
+)
+{
+    // communities of each layer: vertices are ordered by layer and communities by
+    // first vertex, so the communities of each layer follow those of the previous ones
+    auto partition = generalized_louvain(idx, 1.0, 0.0, Coupling::CATEGORICAL, true, num_threads);
+
+    std::vector<int> layer_of(partition.num_communities);
+    size_t n = idx.num_actors();
+    std::vector<size_t> start(n + 1, 0);
+
+    for (size_t l = 0; l < idx.num_layers(); l++)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t v = 0; v < li.num_vertices(); v++)
+        {
+            layer_of[partition.membership[li.offset + v]] = l;
+            start[li.actor[v] + 1]++;
+        }
+    }
+
+    for (size_t a = 0; a < n; a++)
+    {
+        start[a+1] += start[a];
+    }
+
+    std::vector<int> item(start[n]);
+    std::vector<size_t> pos(start.begin(), start.end() - 1);
+
+    for (size_t l = 0; l < idx.num_layers(); l++)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t v = 0; v < li.num_vertices(); v++)
+        {
+            item[pos[li.actor[v]]++] = partition.membership[li.offset + v];
+        }
+    }
+
+    auto itemsets = closed_itemsets(start, item, partition.num_communities, min_actors, min_layers, budget, num_threads);
+
+    // vertices of each community, by layer and position
+    std::vector<std::vector<std::pair<int, int>>> vertices(itemsets.size());
+
+    parallel_for(itemsets.size(), num_threads, [&](size_t c, size_t)
+    {
+        auto& res = vertices[c];
+
+        for (size_t p = itemsets.item_start[c]; p < itemsets.item_start[c+1]; p++)
+        {
+            int l = layer_of[itemsets.item[p]];
+
+            for (size_t q = itemsets.tid_start[c]; q < itemsets.tid_start[c+1]; q++)
+            {
+                res.push_back(std::make_pair(l, idx.vertex_of[l][itemsets.tid[q]]));
+            }
+        }
+
+        std::sort(res.begin(), res.end());
+    });
+
+    AbacusCommunities res;
+    res.complete = itemsets.complete;
+    res.communities.start.assign(1, 0);
+
+    for (auto& v: vertices)
+    {
+        for (auto& lv: v)
+        {
+            res.communities.layer.push_back(lv.first);
+            res.communities.vertex.push_back(lv.second);
+        }
+
+        res.communities.start.push_back(res.communities.layer.size());
+    }
+
+    return res;
+}
@@ -0,0 +1,97 @@
+#ifndef UU_R_MULTINET_ABACUS_H_
+#define UU_R_MULTINET_ABACUS_H_
+
+#include <cstddef>
+#include <vector>
+#include "communities.h"
+#include "ml_index.h"
+
+/**
+ * Limits to the search for itemsets; 0 means no limit.
+ */
+struct MiningBudget
+{
+    // maximum number of itemsets to return
+    size_t max_itemsets;
+
+    // maximum time of the search, in seconds
+    double max_seconds;
+};
+
+/**
+ * Closed itemsets, each with the (sorted) items it contains and the (sorted)
+ * transactions containing it.
+ */
+struct ClosedItemsets
+{
+    std::vector<size_t> item_start;
+    std::vector<int> item;
+    std::vector<size_t> tid_start;
+    std::vector<int> tid;
+
+    // false if the search has been stopped by the budget
+    bool complete;
+
+    size_t
+    size(
+    ) const
+    {
+        return item_start.size() - 1;
+    }
+};
+
+/**
+ * Closed itemsets of at least min_size items contained in at least min_support of the
+ * transactions, where transaction t contains the items item[start[t]], ...,
+ * item[start[t+1]-1] (between 0 and num_items - 1).
+ *
+ * The itemsets are enumerated depth-first by prefix-preserving closure extension (as in
+ * LCM), so that each closed itemset is generated once and without checking the others.
+ * The branches starting with each frequent item are processed in parallel, each on the
+ * transactions containing that item: tidsets are bit-vectors over these transactions,
+ * intersected and counted a word at a time. Without budget, itemsets are returned in
+ * the order of the depth-first search, independently of the number of threads; if the
+ * budget is exhausted, they are the ones found until then.
+ */
+ClosedItemsets
+closed_itemsets(
+    const std::vector<size_t>& start,
+    const std::vector<int>& item,
+    size_t num_items,
+    size_t min_support,
+    size_t min_size,
+    const MiningBudget& budget,
+    size_t num_threads
+);
+
+/**
+ * Communities found by abacus().
+ */
+struct AbacusCommunities
+{
+    VertexCommunities communities;
+
+    // false if the search has been stopped by the budget
+    bool complete;
+};
+
+/**
+ * ABACUS (Berlingerio et al.): the communities of each layer are computed with the
+ * louvain method; then, each actor is a transaction containing its community on each
+ * layer, and each closed itemset contained in at least min_actors actors and with at
+ * least min_layers items is a community with these actors on the layers of the items.
+ * Edge directionality and self-loops are ignored.
+ *
+ * The communities of all the layers are found concurrently, by a deterministic run of
+ * generalized_louvain() with omega = 0, where the layers are independent.
+ */
+AbacusCommunities
+abacus(
+    const MLIndex& idx,
+    size_t min_actors,
+    size_t min_layers,
+    const MiningBudget& budget,
+    size_t num_threads
+);
+
+#endif
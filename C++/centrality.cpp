@@ -0,0 +1,325 @@
+#include "centrality.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace {
+
+// working memory of a breadth-first search, reset after each run
+struct BFSWorkspace
+{
+    std::vector<int> dist;
+    std::vector<double> sigma;
+    std::vector<double> delta;
+    std::vector<int> order;
+
+    explicit
+    BFSWorkspace(
+        size_t n
+    ) : dist(n, -1), sigma(n, 0), delta(n, 0)
+    {
+        order.reserve(n);
+    }
+
+    // visits the actors reachable from source in non-decreasing distance order
+    void
+    run(
+        const ActorGraph& g,
+        int source,
+        bool count_paths
+    )
+    {
+        for (auto v: order)
+        {
+            dist[v] = -1;
+            sigma[v] = 0;
+            delta[v] = 0;
+        }
+
+        order.clear();
+        dist[source] = 0;
+        sigma[source] = 1;
+        order.push_back(source);
+
+        for (size_t head = 0; head < order.size(); head++)
+        {
+            int v = order[head];
+
+            for (size_t p = g.start[v]; p < g.start[v+1]; p++)
+            {
+                int w = g.nbr[p];
+
+                if (dist[w] < 0)
+                {
+                    dist[w] = dist[v] + 1;
+                    order.push_back(w);
+                }
+
+                if (count_paths && dist[w] == dist[v] + 1)
+                {
+                    sigma[w] += sigma[v];
+                }
+            }
+        }
+    }
+};
+
+/*
+ * Calls f(task, acc, workspace) for all tasks, where acc is one of a fixed number of
+ * accumulators, each used by a contiguous range of tasks. The accumulators are summed
+ * in order at the end, so the result does not depend on the number of threads.
+ */
+template <typename F>
+std::vector<double>
+accumulate_tasks(
+    const ActorGraph& g,
+    size_t num_tasks,
+    size_t num_threads,
+    F f
+)
+{
+    size_t n = g.num_actors();
+
+    // at most 64 accumulators, taking at most 128MB
+    size_t num_chunks = std::min<size_t>(64, std::max<size_t>(1, ((size_t)1 << 24) / std::max<size_t>(n, 1)));
+    num_chunks = std::max<size_t>(1, std::min(num_chunks, num_tasks));
+
+    std::vector<std::vector<double>> acc(num_chunks, std::vector<double>(n, 0));
+    std::vector<std::unique_ptr<BFSWorkspace>> workspaces(num_threads);
+
+    parallel_for(num_chunks, num_threads, [&](size_t c, size_t t)
+    {
+        if (!workspaces[t])
+        {
+            workspaces[t].reset(new BFSWorkspace(n));
+        }
+
+        size_t begin = num_tasks * c / num_chunks;
+        size_t end = num_tasks * (c + 1) / num_chunks;
+
+        for (size_t task = begin; task < end; task++)
+        {
+            f(task, acc[c], *workspaces[t]);
+        }
+    });
+
+    for (size_t c = 1; c < num_chunks; c++)
+    {
+        for (size_t v = 0; v < n; v++)
+        {
+            acc[0][v] += acc[c][v];
+        }
+
+        std::vector<double>().swap(acc[c]);
+    }
+
+    return acc[0];
+}
+
+// f(u) for each neighbor u of vertex v on a layer, following the outgoing edges (out),
+// the incoming edges (in) or both; when both are followed on a directed layer the two
+// sorted lists are merged, so that a neighbor in both directions is visited once
+template <typename F>
+void
+for_each_neighbor(
+    const LayerIndex& layer,
+    size_t v,
+    bool out,
+    bool in,
+    F f
+)
+{
+    bool follow_out = out || !layer.directed;
+    bool follow_in = in && layer.directed;
+    const int* p = follow_out ? layer.out_begin(v) : layer.out_end(v);
+    const int* p_end = layer.out_end(v);
+    const int* q = follow_in ? layer.in_begin(v) : layer.in_end(v);
+    const int* q_end = layer.in_end(v);
+
+    while (p != p_end || q != q_end)
+    {
+        if (q == q_end || (p != p_end && *p < *q))
+        {
+            f(*p++);
+        }
+
+        else if (p == p_end || *q < *p)
+        {
+            f(*q++);
+        }
+
+        else
+        {
+            f(*p++);
+            q++;
+        }
+    }
+}
+
+}
+
+ActorGraph
+actor_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    bool out,
+    bool in
+)
+{
+    size_t n = idx.num_actors();
+    ActorGraph g;
+    g.start.assign(n + 1, 0);
+
+    // pass 0 counts the neighbors of each actor, pass 1 stores them
+    for (int pass = 0; pass < 2; pass++)
+    {
+        std::vector<size_t> pos;
+
+        if (pass == 1)
+        {
+            for (size_t a = 0; a < n; a++)
+            {
+                g.start[a+1] += g.start[a];
+            }
+
+            g.nbr.resize(g.start[n]);
+            pos.assign(g.start.begin(), g.start.end() - 1);
+        }
+
+        for (auto l: layers)
+        {
+            const LayerIndex& layer = idx.layers[l];
+
+            for (size_t v = 0; v < layer.num_vertices(); v++)
+            {
+                int a = layer.actor[v];
+
+                for_each_neighbor(layer, v, out, in, [&](int u)
+                {
+                    if (pass == 0)
+                    {
+                        g.start[a+1]++;
+                    }
+
+                    else
+                    {
+                        g.nbr[pos[a]++] = layer.actor[u];
+                    }
+                });
+            }
+        }
+    }
+
+    std::vector<bool> is_present(n, false);
+
+    for (auto l: layers)
+    {
+        for (auto a: idx.layers[l].actor)
+        {
+            is_present[a] = true;
+        }
+    }
+
+    for (size_t a = 0; a < n; a++)
+    {
+        if (is_present[a])
+        {
+            g.present.push_back(a);
+        }
+    }
+
+    return g;
+}
+
+std::vector<double>
+dependency_sums(
+    const ActorGraph& g,
+    const std::vector<int>& sources,
+    size_t num_threads
+)
+{
+    return accumulate_tasks(g, sources.size(), num_threads,
+                            [&](size_t task, std::vector<double>& acc, BFSWorkspace& ws)
+    {
+        ws.run(g, sources[task], true);
+
+        // in non-increasing distance order, so that the dependencies of the
+        // successors of v are complete when v is processed
+        for (size_t i = ws.order.size(); i-- > 0; )
+        {
+            int v = ws.order[i];
+
+            for (size_t p = g.start[v]; p < g.start[v+1]; p++)
+            {
+                int w = g.nbr[p];
+
+                if (ws.dist[w] == ws.dist[v] + 1)
+                {
+                    ws.delta[v] += ws.sigma[v] / ws.sigma[w] * (1 + ws.delta[w]);
+                }
+            }
+
+            if (i > 0)
+            {
+                acc[v] += ws.delta[v];
+            }
+        }
+    });
+}
+
+std::vector<double>
+inverse_distance_sums(
+    const ActorGraph& rg,
+    const std::vector<int>& pivots,
+    size_t num_threads
+)
+{
+    return accumulate_tasks(rg, pivots.size(), num_threads,
+                            [&](size_t task, std::vector<double>& acc, BFSWorkspace& ws)
+    {
+        ws.run(rg, pivots[task], false);
+
+        for (size_t i = 1; i < ws.order.size(); i++)
+        {
+            int v = ws.order[i];
+            acc[v] += 1.0 / ws.dist[v];
+        }
+    });
+}
+
+std::vector<int>
+sample_pivots(
+    const ActorGraph& g,
+    size_t k,
+    uint64_t seed
+)
+{
+    std::vector<int> res;
+
+    if (g.present.empty())
+    {
+        return res;
+    }
+
+    std::mt19937_64 rng(seed);
+    res.reserve(k);
+
+    for (size_t i = 0; i < k; i++)
+    {
+        res.push_back(g.present[rng() % g.present.size()]);
+    }
+
+    return res;
+}
+
+double
+sampling_error(
+    size_t k,
+    size_t n,
+    double delta
+)
+{
+    return std::sqrt(std::log(2.0 * std::max<size_t>(n, 1) / delta) / (2.0 * k));
+}
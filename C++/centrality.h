@@ -0,0 +1,95 @@
+#ifndef UU_R_MULTINET_CENTRALITY_H_
+#define UU_R_MULTINET_CENTRALITY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Actor-level view of a set of layers: a step from an actor to another is possible on
+ * each layer where they are adjacent, and steps on different layers are different
+ * (so a neighbor appears once for each layer connecting the two actors).
+ * A path length is the total number of steps, on any of the layers.
+ */
+struct ActorGraph
+{
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+
+    // actors present in at least one of the layers
+    std::vector<int> present;
+
+    size_t
+    num_actors(
+    ) const
+    {
+        return start.size() - 1;
+    }
+};
+
+/**
+ * Builds the actor-level view of the input layers (indices in idx.layers), following
+ * the outgoing edges (out), the incoming edges (in) or both.
+ * Undirected edges are always followed. When both directions are followed, two actors
+ * connected by edges in both directions on a directed layer are neighbors once on it.
+ */
+ActorGraph
+actor_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    bool out,
+    bool in
+);
+
+/**
+ * Sum over the source actors of the dependency of each actor on the source
+ * (Brandes' algorithm). With all present actors as sources this is the betweenness
+ * of directed paths; with a uniform sample of k sources it must be scaled by n/k
+ * (Brandes and Pich's pivot sampling).
+ * Sources are processed in parallel and the result does not depend on the number of threads.
+ */
+std::vector<double>
+dependency_sums(
+    const ActorGraph& g,
+    const std::vector<int>& sources,
+    size_t num_threads
+);
+
+/**
+ * For each actor v, sum over the pivots p of 1/d(v,p), where d is computed on g and
+ * unreachable pivots (and v itself) contribute 0. rg must be g with reversed edges.
+ * With all present actors as pivots, dividing by n-1 gives the harmonic closeness;
+ * with a uniform sample of k pivots the sum must be scaled by n/(k(n-1)).
+ * Pivots are processed in parallel and the result does not depend on the number of threads.
+ */
+std::vector<double>
+inverse_distance_sums(
+    const ActorGraph& rg,
+    const std::vector<int>& pivots,
+    size_t num_threads
+);
+
+/**
+ * Samples k actors among g.present, uniformly and with replacement.
+ */
+std::vector<int>
+sample_pivots(
+    const ActorGraph& g,
+    size_t k,
+    uint64_t seed
+);
+
+/**
+ * Half-width of the confidence interval of the average of k independent samples
+ * bounded in [0,1], holding with probability 1-delta simultaneously for n averages
+ * (Hoeffding inequality and union bound).
+ */
+double
+sampling_error(
+    size_t k,
+    size_t n,
+    double delta
+);
+
+#endif
@@ -0,0 +1,922 @@
+#include "cliques.h"
+#include "cores.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+namespace {
+
+// neighborhoods with at most this many words of pairwise layer sets are copied
+// into a dense matrix, larger ones into sorted lists
+const size_t kDenseWords = 1 << 18;
+
+// sets of layers, as W words of bits
+
+size_t
+count(
+    const uint64_t* s,
+    size_t W
+)
+{
+    size_t res = 0;
+
+    for (size_t w = 0; w < W; w++)
+    {
+        res += __builtin_popcountll(s[w]);
+    }
+
+    return res;
+}
+
+bool
+equal(
+    const uint64_t* s1,
+    const uint64_t* s2,
+    size_t W
+)
+{
+    return std::equal(s1, s1 + W, s2);
+}
+
+bool
+contains(
+    const uint64_t* s1,
+    const uint64_t* s2,
+    size_t W
+)
+{
+    for (size_t w = 0; w < W; w++)
+    {
+        if ((s1[w] & s2[w]) != s2[w])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// actors adjacent on at least m layers, with the set of layers where they are adjacent
+struct FlatGraph
+{
+    size_t W;
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+    std::vector<uint64_t> layers;
+};
+
+FlatGraph
+flat_graph(
+    const MLIndex& idx,
+    size_t m,
+    size_t num_threads
+)
+{
+    size_t n = idx.num_actors();
+    size_t L = idx.num_layers();
+
+    std::vector<size_t> all(L);
+
+    for (size_t l = 0; l < L; l++)
+    {
+        all[l] = l;
+    }
+
+    auto g = core_graph(idx, all, num_threads);
+
+    FlatGraph res;
+    res.W = (L + 63) / 64;
+    size_t W = res.W;
+
+    std::vector<std::vector<int>> nbr(n);
+    std::vector<std::vector<uint64_t>> layers(n);
+
+    parallel_for(n, num_threads, [&](size_t a, size_t)
+    {
+        std::vector<std::pair<int, int>> arcs;
+
+        for (size_t l = 0; l < L; l++)
+        {
+            for (size_t p = g.start[l][a]; p < g.start[l][a+1]; p++)
+            {
+                arcs.push_back(std::make_pair(g.nbr[l][p], (int)l));
+            }
+        }
+
+        std::sort(arcs.begin(), arcs.end());
+        std::vector<uint64_t> s(W);
+
+        for (size_t i = 0; i < arcs.size(); )
+        {
+            int b = arcs[i].first;
+            std::fill(s.begin(), s.end(), 0);
+
+            for (; i < arcs.size() && arcs[i].first == b; i++)
+            {
+                s[arcs[i].second / 64] |= (uint64_t)1 << (arcs[i].second % 64);
+            }
+
+            if (count(s.data(), W) >= m)
+            {
+                nbr[a].push_back(b);
+                layers[a].insert(layers[a].end(), s.begin(), s.end());
+            }
+        }
+    }, 256);
+
+    res.start.assign(n + 1, 0);
+
+    for (size_t a = 0; a < n; a++)
+    {
+        res.start[a+1] = res.start[a] + nbr[a].size();
+    }
+
+    res.nbr.resize(res.start[n]);
+    res.layers.resize(res.start[n] * W);
+
+    parallel_for(n, num_threads, [&](size_t a, size_t)
+    {
+        std::copy(nbr[a].begin(), nbr[a].end(), res.nbr.begin() + res.start[a]);
+        std::copy(layers[a].begin(), layers[a].end(), res.layers.begin() + res.start[a] * W);
+    }, 4096);
+
+    return res;
+}
+
+// degeneracy ordering (bin-sort peeling), with the coreness of each actor
+void
+degeneracy_order(
+    const FlatGraph& g,
+    std::vector<int>& order,
+    std::vector<size_t>& core
+)
+{
+    size_t n = g.start.size() - 1;
+    core.resize(n);
+    size_t max_deg = 0;
+
+    for (size_t v = 0; v < n; v++)
+    {
+        core[v] = g.start[v+1] - g.start[v];
+        max_deg = std::max(max_deg, core[v]);
+    }
+
+    std::vector<size_t> bin(max_deg + 1, 0);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        bin[core[v]]++;
+    }
+
+    size_t first = 0;
+
+    for (size_t d = 0; d <= max_deg; d++)
+    {
+        size_t num = bin[d];
+        bin[d] = first;
+        first += num;
+    }
+
+    order.resize(n);
+    std::vector<size_t> pos(n);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        pos[v] = bin[core[v]]++;
+        order[pos[v]] = v;
+    }
+
+    for (size_t d = max_deg; d > 0; d--)
+    {
+        bin[d] = bin[d-1];
+    }
+
+    bin[0] = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int v = order[i];
+
+        for (size_t p = g.start[v]; p < g.start[v+1]; p++)
+        {
+            int u = g.nbr[p];
+
+            if (core[u] > core[v])
+            {
+                // moves u to the first position of its bin, and shrinks the bin
+                size_t du = core[u];
+                size_t pw = bin[du];
+                int w = order[pw];
+
+                if (u != w)
+                {
+                    std::swap(order[pos[u]], order[pw]);
+                    std::swap(pos[u], pos[w]);
+                }
+
+                bin[du]++;
+                core[u]--;
+            }
+        }
+    }
+}
+
+// cliques found from one root
+struct Found
+{
+    std::vector<size_t> actor_end;
+    std::vector<int> actor;
+    std::vector<size_t> layer_end;
+    std::vector<int> layer;
+};
+
+// candidates (P) and excluded actors (X) at one level of the search, by local id,
+// with the layers where they are adjacent to all the actors in the clique
+struct Level
+{
+    std::vector<uint64_t> layers;
+    std::vector<int> p;
+    std::vector<uint64_t> p_layers;
+    std::vector<int> x;
+    std::vector<uint64_t> x_layers;
+    std::vector<char> skip;
+};
+
+// Bron-Kerbosch search from one root at a time, on a local copy of its neighborhood
+class Search
+{
+  public:
+
+    Search(
+        const FlatGraph& g,
+        size_t k,
+        size_t m
+    ) : g_(g), W_(g.W), k_(k), m_(m), local_(g.start.size() - 1, -1)
+    {
+    }
+
+    void
+    run(
+        int root,
+        const std::vector<int>& rank,
+        const std::vector<char>& active,
+        Found& found
+    )
+    {
+        found_ = &found;
+
+        // neighbors of the root, in order of position
+        actors_.clear();
+
+        for (size_t p = g_.start[root]; p < g_.start[root+1]; p++)
+        {
+            int u = g_.nbr[p];
+
+            if (active[u])
+            {
+                local_[u] = actors_.size();
+                actors_.push_back(u);
+            }
+        }
+
+        size_t num_later = 0;
+
+        for (auto u: actors_)
+        {
+            num_later += rank[u] > rank[root];
+        }
+
+        if (num_later + 1 >= k_)
+        {
+            build_local_graph();
+
+            if (levels_.empty())
+            {
+                levels_.emplace_back();
+            }
+
+            auto& top = levels_[0];
+            top.layers.assign(W_, 0);
+            top.p.clear();
+            top.p_layers.clear();
+            top.x.clear();
+            top.x_layers.clear();
+
+            for (size_t p = g_.start[root]; p < g_.start[root+1]; p++)
+            {
+                int u = g_.nbr[p];
+
+                if (!active[u])
+                {
+                    continue;
+                }
+
+                const uint64_t* s = &g_.layers[p * W_];
+                auto& ids = rank[u] > rank[root] ? top.p : top.x;
+                auto& layers = rank[u] > rank[root] ? top.p_layers : top.x_layers;
+                ids.push_back(local_[u]);
+                layers.insert(layers.end(), s, s + W_);
+
+                for (size_t w = 0; w < W_; w++)
+                {
+                    top.layers[w] |= s[w];
+                }
+            }
+
+            clique_.assign(1, root);
+            expand(0);
+        }
+
+        for (auto u: actors_)
+        {
+            local_[u] = -1;
+        }
+    }
+
+  private:
+
+    void
+    build_local_graph(
+    )
+    {
+        size_t d = actors_.size();
+        dense_ = d * d * W_ <= kDenseWords;
+
+        if (dense_)
+        {
+            matrix_.assign(d * d * W_, 0);
+        }
+
+        else
+        {
+            start_.assign(1, 0);
+            nbr_.clear();
+            layers_.clear();
+        }
+
+        for (size_t i = 0; i < d; i++)
+        {
+            int u = actors_[i];
+
+            // neighbors in order of position, hence of local id
+            for (size_t p = g_.start[u]; p < g_.start[u+1]; p++)
+            {
+                int j = local_[g_.nbr[p]];
+
+                if (j < 0)
+                {
+                    continue;
+                }
+
+                const uint64_t* s = &g_.layers[p * W_];
+
+                if (dense_)
+                {
+                    std::copy(s, s + W_, &matrix_[(i * d + j) * W_]);
+                }
+
+                else
+                {
+                    nbr_.push_back(j);
+                    layers_.insert(layers_.end(), s, s + W_);
+                }
+            }
+
+            if (!dense_)
+            {
+                start_.push_back(nbr_.size());
+            }
+        }
+    }
+
+    // layers where the local actors i and j are adjacent, or nullptr
+    const uint64_t*
+    adjacency(
+        int i,
+        int j
+    ) const
+    {
+        if (dense_)
+        {
+            const uint64_t* s = &matrix_[(i * actors_.size() + j) * W_];
+            return count(s, W_) > 0 ? s : nullptr;
+        }
+
+        auto begin = nbr_.begin() + start_[i];
+        auto end = nbr_.begin() + start_[i+1];
+        auto it = std::lower_bound(begin, end, j);
+
+        if (it == end || *it != j)
+        {
+            return nullptr;
+        }
+
+        return &layers_[(it - nbr_.begin()) * W_];
+    }
+
+    // appends u to ids if it is adjacent to v on at least m layers of s and s_u
+    void
+    filter(
+        int v,
+        const uint64_t* s,
+        int u,
+        const uint64_t* s_u,
+        std::vector<int>& ids,
+        std::vector<uint64_t>& layers
+    )
+    {
+        const uint64_t* a = adjacency(v, u);
+
+        if (!a)
+        {
+            return;
+        }
+
+        size_t first = layers.size();
+
+        for (size_t w = 0; w < W_; w++)
+        {
+            layers.push_back(s[w] & s_u[w] & a[w]);
+        }
+
+        if (count(&layers[first], W_) >= m_)
+        {
+            ids.push_back(u);
+        }
+
+        else
+        {
+            layers.resize(first);
+        }
+    }
+
+    void
+    expand(
+        size_t depth
+    )
+    {
+        // references to the elements of a deque are not invalidated by push_back
+        auto& cur = levels_[depth];
+        const uint64_t* s = cur.layers.data();
+        size_t np = cur.p.size();
+        size_t nx = cur.x.size();
+
+        // the actors in P and X can keep at most the layers of the clique; those that
+        // keep all of them can be added without losing layers, and can be pivots
+        std::vector<int> full;
+
+        for (size_t i = 0; i < np; i++)
+        {
+            if (equal(&cur.p_layers[i * W_], s, W_))
+            {
+                full.push_back(cur.p[i]);
+            }
+        }
+
+        for (size_t i = 0; i < nx; i++)
+        {
+            if (equal(&cur.x_layers[i * W_], s, W_))
+            {
+                full.push_back(cur.x[i]);
+            }
+        }
+
+        if (full.empty() && clique_.size() >= k_)
+        {
+            report(s);
+        }
+
+        if (clique_.size() + np < k_)
+        {
+            return;
+        }
+
+        // a maximal clique that does not contain a pivot u contains an actor not
+        // adjacent to u on all the layers of the clique, so the candidates adjacent
+        // to u on all of them are skipped
+        cur.skip.assign(np, 0);
+        size_t best = 0;
+        int pivot = -1;
+
+        for (auto u: full)
+        {
+            size_t num = 0;
+
+            for (size_t i = 0; i < np; i++)
+            {
+                const uint64_t* a = cur.p[i] == u ? nullptr : adjacency(u, cur.p[i]);
+                num += a && contains(a, s, W_);
+            }
+
+            if (pivot < 0 || num > best)
+            {
+                best = num;
+                pivot = u;
+            }
+        }
+
+        if (pivot >= 0)
+        {
+            for (size_t i = 0; i < np; i++)
+            {
+                const uint64_t* a = cur.p[i] == pivot ? nullptr : adjacency(pivot, cur.p[i]);
+                cur.skip[i] = a && contains(a, s, W_);
+            }
+        }
+
+        if (levels_.size() == depth + 1)
+        {
+            levels_.emplace_back();
+        }
+
+        auto& next = levels_[depth + 1];
+
+        for (size_t i = 0; i < np; i++)
+        {
+            if (cur.skip[i])
+            {
+                continue;
+            }
+
+            int v = cur.p[i];
+            const uint64_t* s_v = &cur.p_layers[i * W_];
+            next.layers.assign(s_v, s_v + W_);
+            next.p.clear();
+            next.p_layers.clear();
+            next.x.clear();
+            next.x_layers.clear();
+
+            // processed candidates are marked with skip = 2, and are part of X
+            for (size_t j = 0; j < np; j++)
+            {
+                if (j == i)
+                {
+                    continue;
+                }
+
+                bool excluded = cur.skip[j] == 2;
+                filter(v, s_v, cur.p[j], &cur.p_layers[j * W_],
+                       excluded ? next.x : next.p, excluded ? next.x_layers : next.p_layers);
+            }
+
+            for (size_t j = 0; j < nx; j++)
+            {
+                filter(v, s_v, cur.x[j], &cur.x_layers[j * W_], next.x, next.x_layers);
+            }
+
+            clique_.push_back(actors_[v]);
+            expand(depth + 1);
+            clique_.pop_back();
+            cur.skip[i] = 2;
+        }
+    }
+
+    void
+    report(
+        const uint64_t* s
+    )
+    {
+        size_t first = found_->actor.size();
+        found_->actor.insert(found_->actor.end(), clique_.begin(), clique_.end());
+        std::sort(found_->actor.begin() + first, found_->actor.end());
+        found_->actor_end.push_back(found_->actor.size());
+
+        for (size_t l = 0; l < W_ * 64; l++)
+        {
+            if (s[l / 64] >> (l % 64) & 1)
+            {
+                found_->layer.push_back(l);
+            }
+        }
+
+        found_->layer_end.push_back(found_->layer.size());
+    }
+
+    const FlatGraph& g_;
+    size_t W_;
+    size_t k_;
+    size_t m_;
+
+    // local id of each actor in the neighborhood of the root, or -1
+    std::vector<int> local_;
+    std::vector<int> actors_;
+
+    // layers between local actors: dense matrix or sorted lists
+    bool dense_;
+    std::vector<uint64_t> matrix_;
+    std::vector<size_t> start_;
+    std::vector<int> nbr_;
+    std::vector<uint64_t> layers_;
+
+    std::deque<Level> levels_;
+    std::vector<int> clique_;
+    Found* found_;
+};
+
+// number of common elements of two sorted ranges
+size_t
+intersection_size(
+    const int* b1,
+    const int* e1,
+    const int* b2,
+    const int* e2
+)
+{
+    size_t res = 0;
+
+    while (b1 != e1 && b2 != e2)
+    {
+        if (*b1 < *b2)
+        {
+            ++b1;
+        }
+
+        else if (*b2 < *b1)
+        {
+            ++b2;
+        }
+
+        else
+        {
+            res++;
+            ++b1;
+            ++b2;
+        }
+    }
+
+    return res;
+}
+
+}
+
+MultilayerCliques
+multilayer_cliques(
+    const MLIndex& idx,
+    size_t k,
+    size_t m,
+    size_t num_threads
+)
+{
+    auto g = flat_graph(idx, m, num_threads);
+    size_t n = idx.num_actors();
+
+    std::vector<int> order;
+    std::vector<size_t> core;
+    degeneracy_order(g, order, core);
+
+    std::vector<int> rank(n);
+    std::vector<char> active(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        rank[order[i]] = i;
+    }
+
+    // the actors of a clique with k actors are in the (k-1)-core
+    for (size_t a = 0; a < n; a++)
+    {
+        active[a] = core[a] + 1 >= k;
+    }
+
+    std::vector<Found> found(n);
+    std::vector<std::unique_ptr<Search>> workspaces(num_threads);
+
+    parallel_for(n, num_threads, [&](size_t a, size_t t)
+    {
+        if (!active[a])
+        {
+            return;
+        }
+
+        if (!workspaces[t])
+        {
+            workspaces[t].reset(new Search(g, k, m));
+        }
+
+        workspaces[t]->run(a, rank, active, found[a]);
+    }, 16);
+
+    MultilayerCliques res;
+    res.actor_start.assign(1, 0);
+    res.layer_start.assign(1, 0);
+
+    for (auto& f: found)
+    {
+        for (size_t i = 0; i < f.actor_end.size(); i++)
+        {
+            res.actor_start.push_back(res.actor.size() + f.actor_end[i]);
+            res.layer_start.push_back(res.layer.size() + f.layer_end[i]);
+        }
+
+        res.actor.insert(res.actor.end(), f.actor.begin(), f.actor.end());
+        res.layer.insert(res.layer.end(), f.layer.begin(), f.layer.end());
+    }
+
+    return res;
+}
+
+VertexCommunities
+clique_percolation(
+    const MLIndex& idx,
+    size_t k,
+    size_t m,
+    size_t num_threads
+)
+{
+    auto cliques = multilayer_cliques(idx, k, m, num_threads);
+    size_t C = cliques.size();
+    size_t n = idx.num_actors();
+
+    // cliques of each actor, in order
+    std::vector<size_t> start(n + 1, 0);
+
+    for (auto a: cliques.actor)
+    {
+        start[a + 1]++;
+    }
+
+    for (size_t a = 0; a < n; a++)
+    {
+        start[a+1] += start[a];
+    }
+
+    std::vector<int> clique_of(cliques.actor.size());
+    std::vector<size_t> pos(start.begin(), start.end() - 1);
+
+    for (size_t c = 0; c < C; c++)
+    {
+        for (size_t p = cliques.actor_start[c]; p < cliques.actor_start[c+1]; p++)
+        {
+            clique_of[pos[cliques.actor[p]]++] = c;
+        }
+    }
+
+    // union-find on the cliques; parent[c] <= c at any time, so the final root of a
+    // component is its first clique
+    std::unique_ptr<std::atomic<int>[]> parent(new std::atomic<int>[C]);
+
+    for (size_t c = 0; c < C; c++)
+    {
+        parent[c].store(c, std::memory_order_relaxed);
+    }
+
+    auto find = [&](int x)
+    {
+        while (true)
+        {
+            int p = parent[x].load(std::memory_order_relaxed);
+
+            if (p == x)
+            {
+                return x;
+            }
+
+            int gp = parent[p].load(std::memory_order_relaxed);
+
+            if (gp != p)
+            {
+                parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            }
+
+            x = gp;
+        }
+    };
+
+    auto unite = [&](int u, int w)
+    {
+        u = find(u);
+        w = find(w);
+
+        while (u != w)
+        {
+            if (u < w)
+            {
+                std::swap(u, w);
+            }
+
+            int expected = u;
+
+            if (parent[u].compare_exchange_strong(expected, w))
+            {
+                break;
+            }
+
+            u = find(u);
+            w = find(w);
+        }
+    };
+
+    // shared actors with each following clique, counted through the lists of the actors:
+    // each candidate clique is listed once for each shared actor, and the lists are sorted
+    // to count the repetitions, so memory grows with the candidates of a clique and not
+    // with the number of cliques
+    std::vector<std::vector<int>> candidates(num_threads);
+
+    parallel_for(C, num_threads, [&](size_t c, size_t t)
+    {
+        auto& list = candidates[t];
+        list.clear();
+
+        for (size_t p = cliques.actor_start[c]; p < cliques.actor_start[c+1]; p++)
+        {
+            int a = cliques.actor[p];
+
+            for (size_t q = start[a]; q < start[a+1]; q++)
+            {
+                int d = clique_of[q];
+
+                if (d > (int)c)
+                {
+                    list.push_back(d);
+                }
+            }
+        }
+
+        std::sort(list.begin(), list.end());
+
+        for (size_t i = 0; i < list.size(); )
+        {
+            int d = list[i];
+            size_t j = i;
+
+            while (j < list.size() && list[j] == d)
+            {
+                j++;
+            }
+
+            size_t num = j - i;
+            i = j;
+
+            if (num + 1 >= k && find(c) != find(d))
+            {
+                const int* l = cliques.layer.data();
+                size_t shared = intersection_size(
+                                    l + cliques.layer_start[c], l + cliques.layer_start[c+1],
+                                    l + cliques.layer_start[d], l + cliques.layer_start[d+1]);
+
+                if (shared >= m)
+                {
+                    unite(c, d);
+                }
+            }
+        }
+    }, 64);
+
+    // communities in order of their first clique
+    std::vector<int> id(C, -1);
+    std::vector<std::vector<int>> members;
+
+    for (size_t c = 0; c < C; c++)
+    {
+        int& i = id[find(c)];
+
+        if (i < 0)
+        {
+            i = members.size();
+            members.emplace_back();
+        }
+
+        members[i].push_back(c);
+    }
+
+    std::vector<std::vector<std::pair<int, int>>> vertices(members.size());
+
+    parallel_for(members.size(), num_threads, [&](size_t i, size_t)
+    {
+        auto& res = vertices[i];
+
+        for (auto c: members[i])
+        {
+            for (size_t q = cliques.layer_start[c]; q < cliques.layer_start[c+1]; q++)
+            {
+                int l = cliques.layer[q];
+
+                for (size_t p = cliques.actor_start[c]; p < cliques.actor_start[c+1]; p++)
+                {
+                    res.push_back(std::make_pair(l, idx.vertex_of[l][cliques.actor[p]]));
+                }
+            }
+        }
+
+        std::sort(res.begin(), res.end());
+        res.erase(std::unique(res.begin(), res.end()), res.end());
+    });
+
+    VertexCommunities res;
+    res.start.assign(1, 0);
+
+    for (auto& v: vertices)
+    {
+        for (auto& lv: v)
+        {
+            res.layer.push_back(lv.first);
+            res.vertex.push_back(lv.second);
+        }
+
+        res.start.push_back(res.layer.size());
+    }
+
+    return res;
+}
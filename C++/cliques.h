@@ -0,0 +1,68 @@
+#ifndef UU_R_MULTINET_CLIQUES_H_
+#define UU_R_MULTINET_CLIQUES_H_
+
+#include <cstddef>
+#include <vector>
+#include "communities.h"
+#include "ml_index.h"
+
+/**
+ * Multilayer cliques: sets of actors A and layers T such that the actors in A are
+ * pairwise adjacent on every layer in T.
+ */
+struct MultilayerCliques
+{
+    // actors of clique i (sorted positions): actor[actor_start[i]], ..., actor[actor_start[i+1]-1]
+    std::vector<size_t> actor_start;
+    std::vector<int> actor;
+
+    // layers of clique i (sorted indices in idx.layers), in the same format
+    std::vector<size_t> layer_start;
+    std::vector<int> layer;
+
+    size_t
+    size(
+    ) const
+    {
+        return actor_start.size() - 1;
+    }
+};
+
+/**
+ * Maximal multilayer cliques with at least k actors and m layers, where edge
+ * directionality and self-loops are ignored. A clique (A, T) is maximal if no actor
+ * can be added to A keeping all the layers in T; T contains all the layers where A is
+ * a clique.
+ *
+ * Cliques are enumerated by Bron-Kerbosch with pivoting on the graph of the actors
+ * adjacent on at least m layers, restricted to its (k-1)-core. Each actor is the root
+ * of the cliques whose other actors follow it in a degeneracy ordering, so that the
+ * candidates of a root are at most as many as the degeneracy of the graph; roots are
+ * processed in parallel, each on a local copy of its neighborhood. The cliques are
+ * returned in order of their first actor, independently of the number of threads.
+ */
+MultilayerCliques
+multilayer_cliques(
+    const MLIndex& idx,
+    size_t k,
+    size_t m,
+    size_t num_threads
+);
+
+/**
+ * Multilayer clique percolation (Afsarmanesh and Magnani): two maximal cliques are
+ * adjacent if they share at least k-1 actors and m layers, and each community contains
+ * the vertices of the cliques in a component of the adjacency graph. Adjacent pairs
+ * are found through the cliques of each actor and merged in parallel by a lock-free
+ * union-find on the clique identifiers, skipping pairs already in the same set.
+ * Communities are numbered in order of their first clique.
+ */
+VertexCommunities
+clique_percolation(
+    const MLIndex& idx,
+    size_t k,
+    size_t m,
+    size_t num_threads
+);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef UU_R_MULTINET_COMMUNITIES_H_
+#define UU_R_MULTINET_COMMUNITIES_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Overlapping communities, as lists of vertices.
+ */
+struct VertexCommunities
+{
+    // vertices of community c, sorted by layer and then by position in the layer:
+    // (layer[start[c]], vertex[start[c]]), ..., up to start[c+1]-1
+    std::vector<size_t> start;
+    std::vector<int> layer;
+    std::vector<int> vertex;
+
+    size_t
+    num_communities(
+    ) const
+    {
+        return start.size() - 1;
+    }
+};
+
+/**
+ * Overlapping communities, as lists of communities of each vertex (identified by its
+ * global position): vertex v is in the communities community[start[v]], ...,
+ * community[start[v+1]-1], sorted.
+ */
+struct VertexCover
+{
+    std::vector<size_t> start;
+    std::vector<int> community;
+
+    size_t
+    num_vertices(
+    ) const
+    {
+        return start.size() - 1;
+    }
+};
+
+#endif
@@ -0,0 +1,666 @@
+#include "comparison.h"
+#include "parallel.h"
+#include "core/exceptions/WrongParameterException.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+// communities of x per task when partial results are reduced in order
+const size_t kChunkSize = 1024;
+
+// number of communities in membership (-1 for vertices without a community)
+size_t
+num_communities(
+    const std::vector<int>& membership
+)
+{
+    int max = -1;
+
+    for (auto c: membership)
+    {
+        max = std::max(max, c);
+    }
+
+    return max + 1;
+}
+
+// sum of f(n_a) over the sizes n_a of the non-empty communities of x
+template <typename F>
+auto
+marginal_sum(
+    const std::vector<int>& x,
+    F f
+)
+{
+    std::vector<size_t> size(num_communities(x), 0);
+
+    for (auto c: x)
+    {
+        if (c >= 0)
+        {
+            size[c]++;
+        }
+    }
+
+    decltype(f(0)) res = 0;
+
+    for (auto n: size)
+    {
+        if (n > 0)
+        {
+            res += f(n);
+        }
+    }
+
+    return res;
+}
+
+// sum of f(n_ab) over the non-empty cells of the contingency table of x and y, where
+// n_ab is the number of vertices in community a of x and b of y
+template <typename F>
+auto
+cell_sum(
+    const std::vector<int>& x,
+    const std::vector<int>& y,
+    F f,
+    size_t num_threads
+)
+{
+    size_t n = x.size();
+    size_t num_x = num_communities(x);
+    size_t num_y = num_communities(y);
+
+    // vertices grouped by community of x
+    std::vector<size_t> start(num_x + 1, 0);
+
+    for (auto c: x)
+    {
+        if (c >= 0)
+        {
+            start[c + 1]++;
+        }
+    }
+
+    for (size_t c = 0; c < num_x; c++)
+    {
+        start[c+1] += start[c];
+    }
+
+    std::vector<int> vertex(start[num_x]);
+    std::vector<size_t> next(start.begin(), start.end() - 1);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        if (x[v] >= 0)
+        {
+            vertex[next[x[v]]++] = v;
+        }
+    }
+
+    size_t num_chunks = (num_x + kChunkSize - 1) / kChunkSize;
+    std::vector<decltype(f(0))> partial(num_chunks, 0);
+    std::vector<std::vector<size_t>> counts(num_threads);
+    std::vector<std::vector<int>> touched(num_threads);
+
+    parallel_for(num_chunks, num_threads, [&](size_t chunk, size_t t)
+    {
+        auto& count = counts[t];
+        count.resize(num_y, 0);
+        size_t end = std::min(num_x, (chunk + 1) * kChunkSize);
+
+        for (size_t a = chunk * kChunkSize; a < end; a++)
+        {
+            for (size_t p = start[a]; p < start[a+1]; p++)
+            {
+                int b = y[vertex[p]];
+
+                if (b >= 0 && count[b]++ == 0)
+                {
+                    touched[t].push_back(b);
+                }
+            }
+
+            for (auto b: touched[t])
+            {
+                partial[chunk] += f(count[b]);
+                count[b] = 0;
+            }
+
+            touched[t].clear();
+        }
+    });
+
+    decltype(f(0)) res = 0;
+
+    for (auto s: partial)
+    {
+        res += s;
+    }
+
+    return res;
+}
+
+void
+check_partitions(
+    const std::vector<int>& x,
+    const std::vector<int>& y
+)
+{
+    if (x.size() != y.size())
+    {
+        throw uu::core::WrongParameterException("the partitions must contain the same vertices");
+    }
+
+    for (size_t v = 0; v < x.size(); v++)
+    {
+        if (x[v] < 0 || (size_t)x[v] >= x.size() || y[v] < 0 || (size_t)y[v] >= y.size())
+        {
+            throw uu::core::WrongParameterException("community identifiers must be between 0 and the number of vertices - 1");
+        }
+    }
+}
+
+double
+nmi(
+    const std::vector<int>& x,
+    const std::vector<int>& y,
+    size_t num_threads
+)
+{
+    size_t n = x.size();
+
+    if (n == 0)
+    {
+        return 1;
+    }
+
+    auto n_log_n = [](size_t k)
+    {
+        return k * std::log((double)k);
+    };
+
+    double sum_x = marginal_sum(x, n_log_n);
+    double sum_y = marginal_sum(y, n_log_n);
+    double sum_xy = cell_sum(x, y, n_log_n, num_threads);
+
+    // entropies and mutual information, multiplied by n
+    double h_x = n_log_n(n) - sum_x;
+    double h_y = n_log_n(n) - sum_y;
+    double i_xy = sum_xy - sum_x - sum_y + n_log_n(n);
+
+    // both partitions with a single community
+    if (h_x + h_y <= 0)
+    {
+        return 1;
+    }
+
+    return 2 * i_xy / (h_x + h_y);
+}
+
+// number of pairs of vertices sharing i communities in x and j in y, at (i, j)
+typedef std::vector<std::vector<uint64_t>> PairCounts;
+
+void
+add(
+    PairCounts& counts,
+    size_t i,
+    size_t j,
+    uint64_t num_pairs
+)
+{
+    if (counts.size() <= i)
+    {
+        counts.resize(i + 1);
+    }
+
+    if (counts[i].size() <= j)
+    {
+        counts[i].resize(j + 1, 0);
+    }
+
+    counts[i][j] += num_pairs;
+}
+
+uint64_t
+pairs(
+    uint64_t n
+)
+{
+    return n * (n - 1) / 2;
+}
+
+// pair counts of two partitions, from the sizes of their communities and intersections
+PairCounts
+partition_pair_counts(
+    const std::vector<int>& x,
+    const std::vector<int>& y,
+    size_t num_threads
+)
+{
+    auto count_pairs = [](size_t k)
+    {
+        return pairs(k);
+    };
+
+    uint64_t p_x = marginal_sum(x, count_pairs);
+    uint64_t p_y = marginal_sum(y, count_pairs);
+    uint64_t p_xy = cell_sum(x, y, count_pairs, num_threads);
+
+    PairCounts counts;
+    add(counts, 1, 1, p_xy);
+    add(counts, 1, 0, p_x - p_xy);
+    add(counts, 0, 1, p_y - p_xy);
+    return counts;
+}
+
+// number of common elements of two sorted lists
+size_t
+intersection_size(
+    const int* a,
+    const int* a_end,
+    const int* b,
+    const int* b_end
+)
+{
+    size_t res = 0;
+
+    while (a != a_end && b != b_end)
+    {
+        if (*a < *b)
+        {
+            ++a;
+        }
+
+        else if (*b < *a)
+        {
+            ++b;
+        }
+
+        else
+        {
+            res++;
+            ++a;
+            ++b;
+        }
+    }
+
+    return res;
+}
+
+// f(c) for each community c of vertex v, where the communities of y follow the num_x
+// communities of x
+template <typename F>
+void
+for_each_community(
+    const VertexCover& x,
+    const VertexCover& y,
+    size_t num_x,
+    int v,
+    F f
+)
+{
+    for (size_t p = x.start[v]; p < x.start[v+1]; p++)
+    {
+        f(x.community[p]);
+    }
+
+    for (size_t p = y.start[v]; p < y.start[v+1]; p++)
+    {
+        f(num_x + y.community[p]);
+    }
+}
+
+// pair counts of two covers, over the pairs sharing at least one community
+PairCounts
+cover_pair_counts(
+    const VertexCover& x,
+    const VertexCover& y,
+    size_t num_threads
+)
+{
+    size_t n = x.num_vertices();
+
+    // groups of vertices with the same communities in x and y
+    std::vector<int> order(n);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        order[v] = v;
+    }
+
+    auto less = [](const VertexCover& c, int u, int v)
+    {
+        return std::lexicographical_compare(
+                   c.community.begin() + c.start[u], c.community.begin() + c.start[u+1],
+                   c.community.begin() + c.start[v], c.community.begin() + c.start[v+1]);
+    };
+
+    std::sort(order.begin(), order.end(), [&](int u, int v)
+    {
+        if (less(x, u, v) || less(x, v, u))
+        {
+            return less(x, u, v);
+        }
+
+        return less(y, u, v);
+    });
+
+    std::vector<int> first;
+    std::vector<uint64_t> size;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        int v = order[i];
+        int u = first.empty() ? -1 : first.back();
+
+        if (u >= 0 && !less(x, u, v) && !less(y, u, v))
+        {
+            size.back()++;
+        }
+
+        else
+        {
+            first.push_back(v);
+            size.push_back(1);
+        }
+    }
+
+    size_t num_groups = first.size();
+
+    // groups containing each community, with the communities of y after those of x
+    size_t num_x = num_communities(x.community);
+    size_t num_y = num_communities(y.community);
+    std::vector<size_t> start(num_x + num_y + 1, 0);
+
+    for (size_t g = 0; g < num_groups; g++)
+    {
+        for_each_community(x, y, num_x, first[g], [&](size_t c)
+        {
+            start[c + 1]++;
+        });
+    }
+
+    for (size_t c = 0; c < num_x + num_y; c++)
+    {
+        start[c+1] += start[c];
+    }
+
+    std::vector<int> group(start[num_x + num_y]);
+    std::vector<size_t> next(start.begin(), start.end() - 1);
+
+    for (size_t g = 0; g < num_groups; g++)
+    {
+        for_each_community(x, y, num_x, first[g], [&](size_t c)
+        {
+            group[next[c]++] = g;
+        });
+    }
+
+    // each pair of groups sharing a community is counted by the first group, once
+    std::vector<PairCounts> counts(num_threads);
+    std::vector<std::vector<size_t>> seen(num_threads);
+
+    parallel_for(num_groups, num_threads, [&](size_t g, size_t t)
+    {
+        auto& last = seen[t];
+        last.resize(num_groups, num_groups);
+        int u = first[g];
+        size_t num_x_u = x.start[u+1] - x.start[u];
+        size_t num_y_u = y.start[u+1] - y.start[u];
+
+        if (num_x_u > 0 || num_y_u > 0)
+        {
+            add(counts[t], num_x_u, num_y_u, pairs(size[g]));
+        }
+
+        for_each_community(x, y, num_x, first[g], [&](size_t c)
+        {
+            for (size_t p = start[c]; p < start[c+1]; p++)
+            {
+                size_t h = group[p];
+
+                if (h <= g || last[h] == g)
+                {
+                    continue;
+                }
+
+                last[h] = g;
+                int v = first[h];
+                size_t i = intersection_size(
+                               x.community.data() + x.start[u], x.community.data() + x.start[u+1],
+                               x.community.data() + x.start[v], x.community.data() + x.start[v+1]);
+                size_t j = intersection_size(
+                               y.community.data() + y.start[u], y.community.data() + y.start[u+1],
+                               y.community.data() + y.start[v], y.community.data() + y.start[v+1]);
+                add(counts[t], i, j, size[g] * size[h]);
+            }
+        });
+    }, 64);
+
+    PairCounts res;
+
+    for (auto& thread_counts: counts)
+    {
+        for (size_t i = 0; i < thread_counts.size(); i++)
+        {
+            for (size_t j = 0; j < thread_counts[i].size(); j++)
+            {
+                if (thread_counts[i][j] > 0)
+                {
+                    add(res, i, j, thread_counts[i][j]);
+                }
+            }
+        }
+    }
+
+    return res;
+}
+
+// true if each vertex is in at most one community
+bool
+is_partition(
+    const VertexCover& c
+)
+{
+    for (size_t v = 0; v < c.num_vertices(); v++)
+    {
+        if (c.start[v+1] - c.start[v] > 1)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// community of each vertex, or -1
+std::vector<int>
+to_membership(
+    const VertexCover& c
+)
+{
+    std::vector<int> res(c.num_vertices(), -1);
+
+    for (size_t v = 0; v < c.num_vertices(); v++)
+    {
+        if (c.start[v+1] > c.start[v])
+        {
+            res[v] = c.community[c.start[v]];
+        }
+    }
+
+    return res;
+}
+
+void
+check_cover(
+    const VertexCover& c,
+    size_t n
+)
+{
+    if (c.num_vertices() != n || c.start.back() != c.community.size())
+    {
+        throw uu::core::WrongParameterException("the communities must contain the same vertices");
+    }
+
+    for (size_t v = 0; v < n; v++)
+    {
+        for (size_t p = c.start[v]; p < c.start[v+1]; p++)
+        {
+            if (c.community[p] < 0 || (p > c.start[v] && c.community[p] <= c.community[p-1]))
+            {
+                throw uu::core::WrongParameterException("the communities of each vertex must be sorted and non-negative");
+            }
+        }
+    }
+}
+
+double
+omega(
+    const VertexCover& x,
+    const VertexCover& y,
+    size_t num_threads
+)
+{
+    uint64_t n = x.num_vertices();
+
+    PairCounts counts = is_partition(x) && is_partition(y) ?
+                        partition_pair_counts(to_membership(x), to_membership(y), num_threads) :
+                        cover_pair_counts(x, y, num_threads);
+
+    // pairs not sharing any community
+    uint64_t counted = 0;
+
+    for (auto& row: counts)
+    {
+        for (auto k: row)
+        {
+            counted += k;
+        }
+    }
+
+    add(counts, 0, 0, pairs(n) - counted);
+
+    double total = pairs(n);
+
+    if (total == 0)
+    {
+        return 1;
+    }
+
+    // observed agreement, and agreement expected by chance from the marginals
+    size_t max = counts.size();
+
+    for (auto& row: counts)
+    {
+        max = std::max(max, row.size());
+    }
+
+    std::vector<double> x_pairs(max, 0);
+    std::vector<double> y_pairs(max, 0);
+    double observed = 0;
+
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        for (size_t j = 0; j < counts[i].size(); j++)
+        {
+            x_pairs[i] += counts[i][j];
+            y_pairs[j] += counts[i][j];
+
+            if (i == j)
+            {
+                observed += counts[i][j];
+            }
+        }
+    }
+
+    double expected = 0;
+
+    for (size_t k = 0; k < max; k++)
+    {
+        expected += x_pairs[k] * y_pairs[k];
+    }
+
+    observed /= total;
+    expected /= total * total;
+
+    if (expected >= 1)
+    {
+        return 1;
+    }
+
+    return (observed - expected) / (1 - expected);
+}
+
+}
+
+double
+normalized_mutual_information(
+    const std::vector<int>& x,
+    const std::vector<int>& y,
+    size_t num_threads
+)
+{
+    check_partitions(x, y);
+    return nmi(x, y, num_threads);
+}
+
+std::vector<double>
+normalized_mutual_information(
+    const std::vector<int>& reference,
+    const std::vector<std::vector<int>>& candidates,
+    size_t num_threads
+)
+{
+    for (auto& candidate: candidates)
+    {
+        check_partitions(reference, candidate);
+    }
+
+    std::vector<double> res(candidates.size());
+
+    parallel_for(candidates.size(), num_threads, [&](size_t i, size_t)
+    {
+        res[i] = nmi(reference, candidates[i], 1);
+    });
+
+    return res;
+}
+
+double
+omega_index(
+    const VertexCover& x,
+    const VertexCover& y,
+    size_t num_threads
+)
+{
+    check_cover(x, x.num_vertices());
+    check_cover(y, x.num_vertices());
+    return omega(x, y, num_threads);
+}
+
+std::vector<double>
+omega_index(
+    const VertexCover& reference,
+    const std::vector<VertexCover>& candidates,
+    size_t num_threads
+)
+{
+    check_cover(reference, reference.num_vertices());
+
+    for (auto& candidate: candidates)
+    {
+        check_cover(candidate, reference.num_vertices());
+    }
+
+    std::vector<double> res(candidates.size());
+
+    parallel_for(candidates.size(), num_threads, [&](size_t i, size_t)
+    {
+        res[i] = omega(reference, candidates[i], 1);
+    });
+
+    return res;
+}
@@ -0,0 +1,61 @@
+#ifndef UU_R_MULTINET_COMPARISON_H_
+#define UU_R_MULTINET_COMPARISON_H_
+
+#include <cstddef>
+#include <vector>
+#include "communities.h"
+
+/**
+ * Normalized mutual information (Danon et al.) between two partitions of the same
+ * vertices, where x[v] and y[v] are the communities of vertex v, between 0 and the number
+ * of vertices - 1. The contingency table is not stored: the vertices of each community of
+ * x are counted by community of y, in parallel over the communities of x, and the result
+ * does not depend on the number of threads.
+ * @throw WrongParameterException if x and y are not partitions of the same vertices
+ */
+double
+normalized_mutual_information(
+    const std::vector<int>& x,
+    const std::vector<int>& y,
+    size_t num_threads
+);
+
+/**
+ * normalized_mutual_information() between reference and each candidate, processing the
+ * candidates in parallel.
+ */
+std::vector<double>
+normalized_mutual_information(
+    const std::vector<int>& reference,
+    const std::vector<std::vector<int>>& candidates,
+    size_t num_threads
+);
+
+/**
+ * Omega index (Collins and Dent) between two sets of possibly overlapping communities of
+ * the same vertices: the agreement on the number of communities shared by each pair of
+ * vertices, adjusted for chance. Pairs are not enumerated. For partitions, the counts
+ * of the pairs follow from the sizes of the communities and of their intersections.
+ * Otherwise vertices are grouped by their communities in x and y. Then only pairs of
+ * groups sharing a community are compared, in parallel over the groups.
+ * @throw WrongParameterException if x and y do not have the same vertices
+ */
+double
+omega_index(
+    const VertexCover& x,
+    const VertexCover& y,
+    size_t num_threads
+);
+
+/**
+ * omega_index() between reference and each candidate, processing the candidates in
+ * parallel.
+ */
+std::vector<double>
+omega_index(
+    const VertexCover& reference,
+    const std::vector<VertexCover>& candidates,
+    size_t num_threads
+);
+
+#endif
@@ -0,0 +1,537 @@
+#include "components.h"
+#include "parallel.h"
+#include <atomic>
+#include <memory>
+
+namespace {
+
+// numbers the components in order of their first vertex
+Components
+renumber(
+    const std::vector<int>& label,
+    size_t num_labels
+)
+{
+    Components res;
+    res.membership.resize(label.size());
+    std::vector<int> id(num_labels, -1);
+
+    for (size_t v = 0; v < label.size(); v++)
+    {
+        int& c = id[label[v]];
+
+        if (c < 0)
+        {
+            c = res.size.size();
+            res.size.push_back(0);
+        }
+
+        res.membership[v] = c;
+        res.size[c]++;
+    }
+
+    return res;
+}
+
+// CSR from a list of arcs (from[i], to[i])
+ArcGraph
+to_arc_graph(
+    size_t n,
+    const std::vector<int>& from,
+    const std::vector<int>& to
+)
+{
+    ArcGraph g;
+    g.start.assign(n + 1, 0);
+
+    for (auto v: from)
+    {
+        g.start[v + 1]++;
+    }
+
+    for (size_t v = 0; v < n; v++)
+    {
+        g.start[v+1] += g.start[v];
+    }
+
+    std::vector<size_t> pos(g.start.begin(), g.start.end() - 1);
+    g.target.resize(from.size());
+
+    for (size_t i = 0; i < from.size(); i++)
+    {
+        g.target[pos[from[i]]++] = to[i];
+    }
+
+    return g;
+}
+
+// keeps the marked vertices, renumbering their components (-1 for the others)
+void
+restrict_to(
+    Components& c,
+    const std::vector<char>& keep
+)
+{
+    std::vector<int> id(c.num_components(), -1);
+    std::vector<size_t> size;
+
+    for (size_t v = 0; v < c.membership.size(); v++)
+    {
+        if (!keep[v])
+        {
+            c.membership[v] = -1;
+            continue;
+        }
+
+        int& k = id[c.membership[v]];
+
+        if (k < 0)
+        {
+            k = size.size();
+            size.push_back(0);
+        }
+
+        c.membership[v] = k;
+        size[k]++;
+    }
+
+    c.size.swap(size);
+}
+
+// vertices with at least one incoming or outgoing arc
+std::vector<char>
+with_arcs(
+    const ArcGraph& g
+)
+{
+    std::vector<char> res(g.num_vertices(), 0);
+
+    for (size_t v = 0; v < g.num_vertices(); v++)
+    {
+        if (g.start[v+1] > g.start[v])
+        {
+            res[v] = 1;
+        }
+    }
+
+    for (auto v: g.target)
+    {
+        res[v] = 1;
+    }
+
+    return res;
+}
+
+void
+add_interlayer(
+    const InterlayerEdge& e,
+    int v1,
+    int v2,
+    std::vector<int>& from,
+    std::vector<int>& to
+)
+{
+    from.push_back(v1);
+    to.push_back(v2);
+
+    if (!e.directed)
+    {
+        from.push_back(v2);
+        to.push_back(v1);
+    }
+}
+
+}
+
+Components
+weak_components(
+    size_t n,
+    const size_t* start,
+    const int* nbr,
+    size_t num_threads
+)
+{
+    std::unique_ptr<std::atomic<int>[]> parent(new std::atomic<int>[n]);
+
+    parallel_for(n, num_threads, [&](size_t v, size_t)
+    {
+        parent[v].store(v, std::memory_order_relaxed);
+    }, 4096);
+
+    // parent[v] <= v at any time, so the final root of a component is its first vertex
+    auto find = [&](int x)
+    {
+        while (true)
+        {
+            int p = parent[x].load(std::memory_order_relaxed);
+
+            if (p == x)
+            {
+                return x;
+            }
+
+            int gp = parent[p].load(std::memory_order_relaxed);
+
+            // path halving: a failed exchange only means that another thread did it
+            if (gp != p)
+            {
+                parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            }
+
+            x = gp;
+        }
+    };
+
+    parallel_for(n, num_threads, [&](size_t v, size_t)
+    {
+        for (size_t p = start[v]; p < start[v+1]; p++)
+        {
+            int u = find(v);
+            int w = find(nbr[p]);
+
+            while (u != w)
+            {
+                if (u < w)
+                {
+                    std::swap(u, w);
+                }
+
+                int expected = u;
+
+                if (parent[u].compare_exchange_strong(expected, w))
+                {
+                    break;
+                }
+
+                u = find(u);
+                w = find(w);
+            }
+        }
+    }, 1024);
+
+    std::vector<int> root(n);
+
+    parallel_for(n, num_threads, [&](size_t v, size_t)
+    {
+        root[v] = find(v);
+    }, 4096);
+
+    return renumber(root, n);
+}
+
+Components
+strong_components(
+    size_t n,
+    const size_t* start,
+    const int* nbr
+)
+{
+    std::vector<int> index(n, -1);
+    std::vector<int> low(n, 0);
+    std::vector<int> label(n, -1);
+    std::vector<int> stack;
+    std::vector<std::pair<int, size_t>> calls;
+    int next_index = 0;
+    int num_labels = 0;
+
+    for (size_t s = 0; s < n; s++)
+    {
+        if (index[s] >= 0)
+        {
+            continue;
+        }
+
+        calls.push_back(std::make_pair((int)s, start[s]));
+        index[s] = low[s] = next_index++;
+        stack.push_back(s);
+
+        while (!calls.empty())
+        {
+            int v = calls.back().first;
+            size_t& p = calls.back().second;
+
+            if (p < start[v+1])
+            {
+                int u = nbr[p++];
+
+                if (index[u] < 0)
+                {
+                    index[u] = low[u] = next_index++;
+                    stack.push_back(u);
+                    calls.push_back(std::make_pair(u, start[u]));
+                }
+
+                else if (label[u] < 0)
+                {
+                    low[v] = std::min(low[v], index[u]);
+                }
+
+                continue;
+            }
+
+            calls.pop_back();
+
+            if (!calls.empty())
+            {
+                int parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+
+            if (low[v] == index[v])
+            {
+                int u;
+
+                do
+                {
+                    u = stack.back();
+                    stack.pop_back();
+                    label[u] = num_labels;
+                }
+                while (u != v);
+
+                num_labels++;
+            }
+        }
+    }
+
+    return renumber(label, num_labels);
+}
+
+Components
+layer_components(
+    const LayerIndex& layer,
+    bool strong,
+    size_t num_threads
+)
+{
+    // weak components can be found from the out lists only, also on directed layers
+    if (strong && layer.directed)
+    {
+        return strong_components(layer.num_vertices(), layer.out_start.data(), layer.out_nbr.data());
+    }
+
+    return weak_components(layer.num_vertices(), layer.out_start.data(), layer.out_nbr.data(), num_threads);
+}
+
+ArcGraph
+supra_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers
+)
+{
+    // position of the first vertex of each input layer in the supra-graph
+    std::vector<int> offset(idx.num_layers(), -1);
+    size_t n = 0;
+
+    for (auto l: layers)
+    {
+        offset[l] = n;
+        n += idx.layers[l].num_vertices();
+    }
+
+    std::vector<int> from, to;
+
+    for (auto l: layers)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t v = 0; v < li.num_vertices(); v++)
+        {
+            for (auto p = li.out_begin(v); p != li.out_end(v); ++p)
+            {
+                from.push_back(offset[l] + v);
+                to.push_back(offset[l] + *p);
+            }
+        }
+    }
+
+    for (auto& e: idx.interlayer)
+    {
+        size_t l1 = idx.layer_of(e.v1);
+        size_t l2 = idx.layer_of(e.v2);
+
+        if (offset[l1] >= 0 && offset[l2] >= 0)
+        {
+            add_interlayer(e, offset[l1] + e.v1 - idx.layers[l1].offset,
+                           offset[l2] + e.v2 - idx.layers[l2].offset, from, to);
+        }
+    }
+
+    return to_arc_graph(n, from, to);
+}
+
+ArcGraph
+flat_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers
+)
+{
+    std::vector<bool> selected(idx.num_layers(), false);
+    std::vector<int> from, to;
+
+    for (auto l: layers)
+    {
+        auto& li = idx.layers[l];
+        selected[l] = true;
+
+        for (size_t v = 0; v < li.num_vertices(); v++)
+        {
+            for (auto p = li.out_begin(v); p != li.out_end(v); ++p)
+            {
+                from.push_back(li.actor[v]);
+                to.push_back(li.actor[*p]);
+            }
+        }
+    }
+
+    for (auto& e: idx.interlayer)
+    {
+        size_t l1 = idx.layer_of(e.v1);
+        size_t l2 = idx.layer_of(e.v2);
+
+        if (selected[l1] && selected[l2])
+        {
+            int a1 = idx.layers[l1].actor[e.v1 - idx.layers[l1].offset];
+            int a2 = idx.layers[l2].actor[e.v2 - idx.layers[l2].offset];
+
+            if (a1 != a2)
+            {
+                add_interlayer(e, a1, a2, from, to);
+            }
+        }
+    }
+
+    return to_arc_graph(idx.num_actors(), from, to);
+}
+
+Components
+graph_components(
+    const ArcGraph& g,
+    bool strong,
+    size_t num_threads
+)
+{
+    if (strong)
+    {
+        return strong_components(g.num_vertices(), g.start.data(), g.target.data());
+    }
+
+    return weak_components(g.num_vertices(), g.start.data(), g.target.data(), num_threads);
+}
+
+ComponentTable
+component_table(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    ComponentGraph graph,
+    bool strong,
+    bool isolated,
+    size_t num_threads
+)
+{
+    ComponentTable res;
+
+    auto add_row = [&](int actor, int layer, int part, int cid)
+    {
+        if (cid >= 0)
+        {
+            res.actor.push_back(actor);
+            res.layer.push_back(layer);
+            res.part.push_back(part);
+            res.cid.push_back(cid);
+        }
+    };
+
+    if (graph == ComponentGraph::LAYERS)
+    {
+        res.parts.resize(layers.size());
+
+        // Tarjan's algorithm is sequential: in this case layers are processed in parallel
+        parallel_for(layers.size(), strong ? num_threads : 1, [&](size_t i, size_t)
+        {
+            auto& li = idx.layers[layers[i]];
+            res.parts[i] = layer_components(li, strong, strong ? 1 : num_threads);
+
+            if (!isolated)
+            {
+                std::vector<char> keep(li.num_vertices());
+
+                for (size_t v = 0; v < li.num_vertices(); v++)
+                {
+                    keep[v] = li.out_degree(v) > 0 || li.in_degree(v) > 0;
+                }
+
+                restrict_to(res.parts[i], keep);
+            }
+        });
+
+        for (size_t i = 0; i < layers.size(); i++)
+        {
+            auto& li = idx.layers[layers[i]];
+
+            for (size_t v = 0; v < li.num_vertices(); v++)
+            {
+                add_row(li.actor[v], layers[i], i, res.parts[i].membership[v]);
+            }
+        }
+
+        return res;
+    }
+
+    if (graph == ComponentGraph::SUPRA)
+    {
+        auto g = supra_graph(idx, layers);
+        res.parts.push_back(graph_components(g, strong, num_threads));
+
+        if (!isolated)
+        {
+            restrict_to(res.parts[0], with_arcs(g));
+        }
+
+        size_t v = 0;
+
+        for (auto l: layers)
+        {
+            auto& li = idx.layers[l];
+
+            for (size_t i = 0; i < li.num_vertices(); i++)
+            {
+                add_row(li.actor[i], l, 0, res.parts[0].membership[v++]);
+            }
+        }
+
+        return res;
+    }
+
+    auto g = flat_graph(idx, layers);
+    res.parts.push_back(graph_components(g, strong, num_threads));
+
+    std::vector<char> keep(idx.num_actors(), 0);
+
+    for (auto l: layers)
+    {
+        for (auto a: idx.layers[l].actor)
+        {
+            keep[a] = 1;
+        }
+    }
+
+    if (!isolated)
+    {
+        auto arcs = with_arcs(g);
+
+        for (size_t a = 0; a < keep.size(); a++)
+        {
+            keep[a] = keep[a] && arcs[a];
+        }
+    }
+
+    restrict_to(res.parts[0], keep);
+
+    for (size_t a = 0; a < idx.num_actors(); a++)
+    {
+        add_row(a, -1, 0, res.parts[0].membership[a]);
+    }
+
+    return res;
+}
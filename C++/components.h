@@ -0,0 +1,154 @@
+#ifndef UU_R_MULTINET_COMPONENTS_H_
+#define UU_R_MULTINET_COMPONENTS_H_
+
+#include <cstddef>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Partition of the vertices of a graph into connected components.
+ * Components are numbered from 0 in order of their first vertex, so the
+ * numbering does not depend on how they have been computed.
+ */
+struct Components
+{
+    std::vector<int> membership;
+    std::vector<size_t> size;
+
+    size_t
+    num_components(
+    ) const
+    {
+        return size.size();
+    }
+};
+
+/**
+ * Directed graph in CSR format, used for the graphs that are not already
+ * available as a LayerIndex.
+ */
+struct ArcGraph
+{
+    std::vector<size_t> start;
+    std::vector<int> target;
+
+    size_t
+    num_vertices(
+    ) const
+    {
+        return start.size() - 1;
+    }
+};
+
+/**
+ * Weakly connected components of the graph with n vertices and arcs from each v to
+ * nbr[start[v]], ..., nbr[start[v+1]-1]. Arcs are processed in parallel by a
+ * lock-free union-find where roots are always linked to smaller roots.
+ */
+Components
+weak_components(
+    size_t n,
+    const size_t* start,
+    const int* nbr,
+    size_t num_threads
+);
+
+/**
+ * Strongly connected components of the same kind of graph (iterative Tarjan's algorithm).
+ */
+Components
+strong_components(
+    size_t n,
+    const size_t* start,
+    const int* nbr
+);
+
+/**
+ * Components of a layer, ignoring edge directionality if strong is false.
+ */
+Components
+layer_components(
+    const LayerIndex& layer,
+    bool strong,
+    size_t num_threads
+);
+
+/**
+ * Supra-graph of the input layers (indices in idx.layers): their vertices, numbered
+ * in order of layer as in vertices_ml(), intralayer edges and interlayer edges between
+ * the input layers. idx must include the interlayer edges.
+ * Undirected edges are stored in both directions.
+ */
+ArcGraph
+supra_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers
+);
+
+/**
+ * Flattened graph of the input layers: actors, with an arc between two actors if
+ * their vertices are adjacent on one of the input layers or through an interlayer edge
+ * between them. idx must include the interlayer edges.
+ */
+ArcGraph
+flat_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers
+);
+
+/**
+ * Components of a graph built by supra_graph() or flat_graph().
+ */
+Components
+graph_components(
+    const ArcGraph& g,
+    bool strong,
+    size_t num_threads
+);
+
+/**
+ * Graphs whose components are listed by component_table().
+ */
+enum class ComponentGraph
+{
+    // each input layer separately
+    LAYERS,
+    // vertices of the input layers, with intralayer and interlayer edges
+    SUPRA,
+    // actors of the input layers (flattened graph)
+    FLAT
+};
+
+/**
+ * Components of the input layers, with one row for each vertex (or actor, for FLAT)
+ * present in the input layers.
+ */
+struct ComponentTable
+{
+    // components of each layer (LAYERS) or of the whole graph (one element)
+    std::vector<Components> parts;
+
+    // rows, by part and then in order of vertex (or actor) position
+    std::vector<int> actor;
+    std::vector<int> layer;
+    std::vector<int> part;
+    std::vector<int> cid;
+};
+
+/**
+ * Computes the (weak or strong) components of the input layers (indices in idx.layers).
+ * If isolated is false, vertices without edges are not listed and are not counted as
+ * components. For SUPRA and FLAT, idx must include the interlayer edges; layer is -1
+ * for the rows of FLAT.
+ */
+ComponentTable
+component_table(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    ComponentGraph graph,
+    bool strong,
+    bool isolated,
+    size_t num_threads
+);
+
+#endif
@@ -0,0 +1,394 @@
+#include "consensus.h"
+#include "glouvain.h"
+#include "label_propagation.h"
+#include "parallel.h"
+#include "core/exceptions/WrongParameterException.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+const size_t kMaxRounds = 20;
+
+// finalizer of splitmix64
+uint64_t
+mix64(
+    uint64_t x
+)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// seed of a run of a round (round 0 is the run of the input algorithm)
+uint64_t
+run_seed(
+    uint64_t seed,
+    size_t round,
+    size_t run
+)
+{
+    return mix64(mix64(seed + round) ^ mix64(run));
+}
+
+/**
+ * Pairs of vertices whose co-membership is counted, each stored once from its smaller
+ * vertex: u is paired with nbr[start[u]], ..., nbr[start[u+1]-1], all larger than u.
+ */
+struct Pairs
+{
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+};
+
+// f(v) for each vertex v > u adjacent to u (vertex i of layer l) or of the same actor
+template <typename F>
+void
+for_each_pair(
+    const MLIndex& idx,
+    const std::vector<size_t>& adj_start,
+    const std::vector<int>& adj_nbr,
+    size_t l,
+    size_t i,
+    F f
+)
+{
+    auto& li = idx.layers[l];
+    auto first = adj_nbr.begin() + adj_start[i];
+    auto last = adj_nbr.begin() + adj_start[i+1];
+
+    // neighbors are sorted, and vertices of later layers have larger positions
+    for (auto p = std::upper_bound(first, last, (int)i); p != last; ++p)
+    {
+        f(li.offset + *p);
+    }
+
+    for (size_t m = l + 1; m < idx.num_layers(); m++)
+    {
+        int j = idx.vertex_of[m][li.actor[i]];
+
+        if (j >= 0)
+        {
+            f(idx.layers[m].offset + j);
+        }
+    }
+}
+
+Pairs
+candidate_pairs(
+    const MLIndex& idx,
+    size_t num_threads
+)
+{
+    size_t n = idx.num_vertices;
+    size_t L = idx.num_layers();
+
+    // undirected layers are used as they are; directed ones are symmetrized
+    std::vector<std::vector<size_t>> sym_start(L);
+    std::vector<std::vector<int>> sym_nbr(L);
+
+    parallel_for(L, num_threads, [&](size_t l, size_t)
+    {
+        if (idx.layers[l].directed)
+        {
+            undirected_adjacency(idx.layers[l], sym_start[l], sym_nbr[l]);
+        }
+    });
+
+    auto adj_start = [&](size_t l) -> const std::vector<size_t>&
+    {
+        return idx.layers[l].directed ? sym_start[l] : idx.layers[l].out_start;
+    };
+
+    auto adj_nbr = [&](size_t l) -> const std::vector<int>&
+    {
+        return idx.layers[l].directed ? sym_nbr[l] : idx.layers[l].out_nbr;
+    };
+
+    Pairs res;
+    res.start.assign(n + 1, 0);
+
+    parallel_for(L, num_threads, [&](size_t l, size_t)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t i = 0; i < li.num_vertices(); i++)
+        {
+            for_each_pair(idx, adj_start(l), adj_nbr(l), l, i, [&](size_t)
+            {
+                res.start[li.offset + i + 1]++;
+            });
+        }
+    });
+
+    for (size_t v = 0; v < n; v++)
+    {
+        res.start[v+1] += res.start[v];
+    }
+
+    res.nbr.resize(res.start[n]);
+
+    parallel_for(L, num_threads, [&](size_t l, size_t)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t i = 0; i < li.num_vertices(); i++)
+        {
+            size_t q = res.start[li.offset + i];
+
+            for_each_pair(idx, adj_start(l), adj_nbr(l), l, i, [&](size_t v)
+            {
+                res.nbr[q++] = v;
+            });
+        }
+    });
+
+    return res;
+}
+
+/**
+ * Number of runs where the vertices of each pair are in the same community, where run r
+ * (0, ..., num_runs-1) finds the membership partition(r). Runs are executed in parallel
+ * in batches of num_threads, and the memberships of a batch are discarded once counted.
+ */
+template <typename F>
+std::vector<size_t>
+count_agreements(
+    const Pairs& pairs,
+    size_t num_runs,
+    F partition,
+    size_t num_threads
+)
+{
+    size_t n = pairs.start.size() - 1;
+    std::vector<size_t> count(pairs.nbr.size(), 0);
+    size_t batch = std::max<size_t>(1, std::min(num_threads, num_runs));
+    std::vector<std::vector<int>> membership(batch);
+
+    for (size_t first = 0; first < num_runs; first += batch)
+    {
+        size_t size = std::min(batch, num_runs - first);
+
+        parallel_for(size, num_threads, [&](size_t r, size_t)
+        {
+            membership[r] = partition(first + r);
+        });
+
+        parallel_for(n, num_threads, [&](size_t u, size_t)
+        {
+            for (size_t p = pairs.start[u]; p < pairs.start[u+1]; p++)
+            {
+                for (size_t r = 0; r < size; r++)
+                {
+                    if (membership[r][u] == membership[r][pairs.nbr[p]])
+                    {
+                        count[p]++;
+                    }
+                }
+            }
+        }, 1024);
+    }
+
+    return count;
+}
+
+// root of the tree of v, halving the path
+int
+find(
+    std::vector<int>& parent,
+    int v
+)
+{
+    while (parent[v] != v)
+    {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+
+    return v;
+}
+
+}
+
+ConsensusPartition
+consensus(
+    const MLIndex& idx,
+    ConsensusAlgorithm algorithm,
+    size_t runs,
+    double threshold,
+    double gamma,
+    double omega,
+    uint64_t seed,
+    size_t num_threads
+)
+{
+    if (runs == 0)
+    {
+        throw uu::core::WrongParameterException("the number of runs must be positive");
+    }
+
+    if (!(threshold > 0 && threshold <= 1))
+    {
+        throw uu::core::WrongParameterException("the threshold must be in (0, 1]");
+    }
+
+    size_t n = idx.num_vertices;
+    auto pairs = candidate_pairs(idx, num_threads);
+    std::vector<size_t> count;
+
+    if (algorithm == ConsensusAlgorithm::GLOUVAIN)
+    {
+        GeneralizedLouvain louvain(idx, Coupling::CATEGORICAL, num_threads);
+
+        count = count_agreements(pairs, runs, [&](size_t r)
+        {
+            return louvain.run_randomized(gamma, omega, run_seed(seed, 0, r)).membership;
+        }, num_threads);
+    }
+
+    else
+    {
+        // label propagation partitions the actors: each vertex gets the label of its actor
+        count = count_agreements(pairs, runs, [&](size_t r)
+        {
+            auto labels = label_propagation(idx, std::vector<int>(), true, run_seed(seed, 0, r), 1);
+            std::vector<int> membership(n);
+
+            for (auto& li: idx.layers)
+            {
+                for (size_t i = 0; i < li.num_vertices(); i++)
+                {
+                    membership[li.offset + i] = labels.membership[li.actor[i]];
+                }
+            }
+
+            return membership;
+        }, num_threads);
+    }
+
+    auto kept = [&](size_t p)
+    {
+        return count[p] >= threshold * runs;
+    };
+
+    ConsensusPartition res;
+    res.iterations = 0;
+    res.converged = false;
+
+    while (true)
+    {
+        res.converged = std::all_of(count.begin(), count.end(), [&](size_t c)
+        {
+            return c == 0 || c == runs;
+        });
+
+        if (res.converged || res.iterations == kMaxRounds)
+        {
+            break;
+        }
+
+        res.iterations++;
+
+        // consensus graph: the kept pairs, in both directions, weighted by the fraction
+        // of the runs that agree on them; the other pairs are not counted anymore
+        std::vector<size_t> start(n + 1, 0);
+
+        for (size_t u = 0; u < n; u++)
+        {
+            for (size_t p = pairs.start[u]; p < pairs.start[u+1]; p++)
+            {
+                if (kept(p))
+                {
+                    start[u + 1]++;
+                    start[pairs.nbr[p] + 1]++;
+                }
+            }
+        }
+
+        for (size_t v = 0; v < n; v++)
+        {
+            start[v+1] += start[v];
+        }
+
+        std::vector<int> nbr(start[n]);
+        std::vector<double> weight(start[n]);
+        std::vector<size_t> pos(start.begin(), start.end() - 1);
+        size_t q = 0;
+
+        for (size_t u = 0; u < n; u++)
+        {
+            size_t first = q;
+
+            for (size_t p = pairs.start[u]; p < pairs.start[u+1]; p++)
+            {
+                if (!kept(p))
+                {
+                    continue;
+                }
+
+                int v = pairs.nbr[p];
+                double w = (double)count[p] / runs;
+                nbr[pos[u]] = v;
+                weight[pos[u]++] = w;
+                nbr[pos[v]] = u;
+                weight[pos[v]++] = w;
+                pairs.nbr[q++] = v;
+            }
+
+            pairs.start[u] = first;
+        }
+
+        pairs.start[n] = q;
+        pairs.nbr.resize(q);
+
+        GeneralizedLouvain louvain(std::move(start), std::move(nbr), std::move(weight));
+
+        count = count_agreements(pairs, runs, [&](size_t r)
+        {
+            return louvain.run_randomized(1, 0, run_seed(seed, res.iterations, r)).membership;
+        }, num_threads);
+    }
+
+    // communities: connected components of the kept pairs, numbered by first vertex
+    std::vector<int> parent(n);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        parent[v] = v;
+    }
+
+    for (size_t u = 0; u < n; u++)
+    {
+        for (size_t p = pairs.start[u]; p < pairs.start[u+1]; p++)
+        {
+            if (kept(p))
+            {
+                int a = find(parent, u);
+                int b = find(parent, pairs.nbr[p]);
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+
+    res.membership.resize(n);
+    res.num_communities = 0;
+    std::vector<int> id(n, -1);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        int& c = id[find(parent, v)];
+
+        if (c < 0)
+        {
+            c = res.num_communities++;
+        }
+
+        res.membership[v] = c;
+    }
+
+    return res;
+}
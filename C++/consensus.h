@@ -0,0 +1,70 @@
+#ifndef UU_R_MULTINET_CONSENSUS_H_
+#define UU_R_MULTINET_CONSENSUS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Algorithms whose partitions are combined by consensus().
+ */
+enum class ConsensusAlgorithm
+{
+    // generalized louvain with categorical coupling, visiting the vertices in random order
+    GLOUVAIN,
+    // multidimensional label propagation, deterministic with a different seed for each run
+    MDLP
+};
+
+/**
+ * Partition of the vertices of a multilayer network (global positions, as in
+ * vertices_ml()) found by consensus(), with communities numbered from 0 in order of
+ * their first vertex.
+ */
+struct ConsensusPartition
+{
+    std::vector<int> membership;
+    size_t num_communities;
+
+    // number of rounds of re-clustering of the consensus graph
+    size_t iterations;
+
+    // false if the runs still disagreed after the maximum number of rounds
+    bool converged;
+};
+
+/**
+ * Consensus clustering (Lancichinetti and Fortunato). The algorithm is run runs times, and
+ * each pair of vertices is weighted by the fraction of the runs where its vertices are in
+ * the same community; pairs with a fraction lower than threshold are removed, and the
+ * louvain method (with resolution 1, visiting the vertices in random order) is run runs
+ * times on the graph of the remaining pairs. This is repeated until all the runs agree on
+ * all the pairs, or for at most 20 rounds; the communities are the connected components
+ * of the remaining pairs.
+ *
+ * Co-membership is only counted for the pairs of vertices that are adjacent on a layer,
+ * ignoring edge directionality and self-loops, and for the pairs of vertices of the same
+ * actor, so memory grows with the number of edges and couplings and not with the square
+ * of the number of vertices. gamma and omega are used by the first runs of GLOUVAIN.
+ *
+ * Runs are executed in parallel, each on one thread and with its own seed derived from
+ * seed, in batches of num_threads runs, so that only one membership per thread is stored
+ * at a time. Agreements are counted exactly, and the result only depends on seed and not
+ * on the number of threads.
+ *
+ * @throw WrongParameterException if runs is 0 or threshold is not in (0, 1]
+ */
+ConsensusPartition
+consensus(
+    const MLIndex& idx,
+    ConsensusAlgorithm algorithm,
+    size_t runs,
+    double threshold,
+    double gamma,
+    double omega,
+    uint64_t seed,
+    size_t num_threads
+);
+
+#endif
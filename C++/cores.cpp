@@ -0,0 +1,405 @@
+#include "cores.h"
+#include "parallel.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <memory>
+
+namespace {
+
+// peeling of the candidates; pos must have num_actors elements set to -1,
+// and is restored before returning
+std::vector<int>
+peel(
+    const CoreGraph& g,
+    const std::vector<size_t>& k,
+    const std::vector<int>& candidates,
+    std::vector<int>& pos
+)
+{
+    size_t m = candidates.size();
+    size_t L = g.num_layers();
+
+    for (size_t i = 0; i < m; i++)
+    {
+        pos[candidates[i]] = i;
+    }
+
+    // degree of each candidate on each layer, among the candidates
+    std::vector<size_t> deg(L * m, 0);
+
+    for (size_t l = 0; l < L; l++)
+    {
+        auto& start = g.start[l];
+        auto& nbr = g.nbr[l];
+
+        for (size_t i = 0; i < m; i++)
+        {
+            int a = candidates[i];
+
+            for (size_t p = start[a]; p < start[a+1]; p++)
+            {
+                if (pos[nbr[p]] >= 0)
+                {
+                    deg[l * m + i]++;
+                }
+            }
+        }
+    }
+
+    std::vector<char> removed(m, 0);
+    std::vector<size_t> queue;
+
+    for (size_t i = 0; i < m; i++)
+    {
+        for (size_t l = 0; l < L; l++)
+        {
+            if (deg[l * m + i] < k[l])
+            {
+                removed[i] = 1;
+                queue.push_back(i);
+                break;
+            }
+        }
+    }
+
+    for (size_t h = 0; h < queue.size(); h++)
+    {
+        int a = candidates[queue[h]];
+
+        for (size_t l = 0; l < L; l++)
+        {
+            auto& start = g.start[l];
+            auto& nbr = g.nbr[l];
+
+            for (size_t p = start[a]; p < start[a+1]; p++)
+            {
+                int j = pos[nbr[p]];
+
+                if (j < 0 || removed[j])
+                {
+                    continue;
+                }
+
+                if (--deg[l * m + j] < k[l])
+                {
+                    removed[j] = 1;
+                    queue.push_back(j);
+                }
+            }
+        }
+    }
+
+    std::vector<int> core;
+    core.reserve(m - queue.size());
+
+    for (size_t i = 0; i < m; i++)
+    {
+        pos[candidates[i]] = -1;
+
+        if (!removed[i])
+        {
+            core.push_back(candidates[i]);
+        }
+    }
+
+    return core;
+}
+
+}
+
+std::vector<size_t>
+layer_coreness(
+    const LayerIndex& layer
+)
+{
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+    undirected_adjacency(layer, start, nbr);
+
+    size_t n = layer.num_vertices();
+    std::vector<size_t> deg(n);
+    size_t max_deg = 0;
+
+    for (size_t v = 0; v < n; v++)
+    {
+        deg[v] = start[v+1] - start[v];
+        max_deg = std::max(max_deg, deg[v]);
+    }
+
+    // vertices sorted by degree, with the first position of each degree in bin
+
+    std::vector<size_t> bin(max_deg + 1, 0);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        bin[deg[v]]++;
+    }
+
+    size_t first = 0;
+
+    for (size_t d = 0; d <= max_deg; d++)
+    {
+        size_t num = bin[d];
+        bin[d] = first;
+        first += num;
+    }
+
+    std::vector<size_t> vert(n);
+    std::vector<size_t> pos(n);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        pos[v] = bin[deg[v]]++;
+        vert[pos[v]] = v;
+    }
+
+    for (size_t d = max_deg; d > 0; d--)
+    {
+        bin[d] = bin[d-1];
+    }
+
+    if (n > 0)
+    {
+        bin[0] = 0;
+    }
+
+    // each vertex is removed with its current degree, which is its coreness
+
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t v = vert[i];
+
+        for (size_t p = start[v]; p < start[v+1]; p++)
+        {
+            size_t u = nbr[p];
+
+            if (deg[u] > deg[v])
+            {
+                size_t du = deg[u];
+                size_t pu = pos[u];
+                size_t pw = bin[du];
+                size_t w = vert[pw];
+
+                if (u != w)
+                {
+                    pos[u] = pw;
+                    vert[pu] = w;
+                    pos[w] = pu;
+                    vert[pw] = u;
+                }
+
+                bin[du]++;
+                deg[u]--;
+            }
+        }
+    }
+
+    return deg;
+}
+
+CoreGraph
+core_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    size_t num_threads
+)
+{
+    size_t n = idx.num_actors();
+    size_t L = layers.size();
+
+    CoreGraph g;
+    g.num_actors = n;
+    g.start.resize(L);
+    g.nbr.resize(L);
+
+    parallel_for(L, num_threads, [&](size_t i, size_t)
+    {
+        auto& li = idx.layers[layers[i]];
+        std::vector<size_t> start;
+        std::vector<int> nbr;
+        undirected_adjacency(li, start, nbr);
+
+        auto& a_start = g.start[i];
+        auto& a_nbr = g.nbr[i];
+        a_start.assign(n + 1, 0);
+
+        for (size_t v = 0; v < li.num_vertices(); v++)
+        {
+            a_start[li.actor[v] + 1] = start[v+1] - start[v];
+        }
+
+        for (size_t a = 0; a < n; a++)
+        {
+            a_start[a+1] += a_start[a];
+        }
+
+        a_nbr.resize(nbr.size());
+
+        for (size_t v = 0; v < li.num_vertices(); v++)
+        {
+            size_t p = a_start[li.actor[v]];
+
+            for (size_t q = start[v]; q < start[v+1]; q++)
+            {
+                a_nbr[p++] = li.actor[nbr[q]];
+            }
+        }
+    });
+
+    return g;
+}
+
+std::vector<int>
+multilayer_core(
+    const CoreGraph& g,
+    const std::vector<size_t>& k,
+    const std::vector<int>& candidates
+)
+{
+    std::vector<int> pos(g.num_actors, -1);
+    return peel(g, k, candidates, pos);
+}
+
+MultilayerCores
+multilayer_cores(
+    const CoreGraph& g,
+    size_t num_threads
+)
+{
+    size_t L = g.num_layers();
+    MultilayerCores res;
+
+    typedef std::map<std::vector<size_t>, std::vector<int>> Level;
+
+    // level 0: the (0,...,0)-core contains all the actors
+    Level level;
+    std::vector<int> all(g.num_actors);
+
+    for (size_t a = 0; a < g.num_actors; a++)
+    {
+        all[a] = a;
+    }
+
+    if (g.num_actors == 0)
+    {
+        return res;
+    }
+
+    level[std::vector<size_t>(L, 0)] = all;
+
+    std::vector<std::unique_ptr<std::vector<int>>> workspaces(num_threads);
+
+    while (!level.empty())
+    {
+        for (auto& core: level)
+        {
+            res.k.push_back(core.first);
+            res.size.push_back(core.second.size());
+        }
+
+        // children whose parents are all non-empty cores
+
+        std::vector<std::vector<size_t>> children;
+
+        for (auto& core: level)
+        {
+            for (size_t l = 0; l < L; l++)
+            {
+                auto child = core.first;
+                child[l]++;
+
+                // each child is generated from its parent on the last non-zero dimension
+                bool last = true;
+
+                for (size_t j = l + 1; j < L; j++)
+                {
+                    if (child[j] > 0)
+                    {
+                        last = false;
+                        break;
+                    }
+                }
+
+                if (!last)
+                {
+                    continue;
+                }
+
+                bool parents = true;
+
+                for (size_t j = 0; j < L && parents; j++)
+                {
+                    if (child[j] > 0)
+                    {
+                        auto parent = child;
+                        parent[j]--;
+                        parents = level.count(parent) > 0;
+                    }
+                }
+
+                if (parents)
+                {
+                    children.push_back(child);
+                }
+            }
+        }
+
+        std::vector<std::vector<int>> cores(children.size());
+
+        parallel_for(children.size(), num_threads, [&](size_t c, size_t t)
+        {
+            if (!workspaces[t])
+            {
+                workspaces[t].reset(new std::vector<int>(g.num_actors, -1));
+            }
+
+            // candidates: intersection of the cores of the parents
+            auto& child = children[c];
+            std::vector<int> candidates;
+            bool first = true;
+
+            for (size_t j = 0; j < L; j++)
+            {
+                if (child[j] == 0)
+                {
+                    continue;
+                }
+
+                auto parent = child;
+                parent[j]--;
+                auto& core = level.at(parent);
+
+                if (first)
+                {
+                    candidates = core;
+                    first = false;
+                }
+
+                else
+                {
+                    std::vector<int> both;
+                    std::set_intersection(candidates.begin(), candidates.end(), core.begin(), core.end(),
+                                          std::back_inserter(both));
+                    candidates.swap(both);
+                }
+            }
+
+            cores[c] = peel(g, child, candidates, *workspaces[t]);
+        });
+
+        Level next;
+
+        for (size_t c = 0; c < children.size(); c++)
+        {
+            if (!cores[c].empty())
+            {
+                next[children[c]].swap(cores[c]);
+            }
+        }
+
+        level.swap(next);
+    }
+
+    return res;
+}
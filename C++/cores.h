@@ -0,0 +1,81 @@
+#ifndef UU_R_MULTINET_CORES_H_
+#define UU_R_MULTINET_CORES_H_
+
+#include <cstddef>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Coreness of each vertex of a layer (position in the layer), ignoring edge
+ * directionality and self-loops. Computed with Batagelj and Zaversnik's bin-sort
+ * algorithm, in time linear in the number of edges.
+ */
+std::vector<size_t>
+layer_coreness(
+    const LayerIndex& layer
+);
+
+/**
+ * Undirected actor-level adjacency of a set of layers, one CSR per layer,
+ * indexed by actor position (actors not in a layer have no neighbors there).
+ */
+struct CoreGraph
+{
+    size_t num_actors;
+    std::vector<std::vector<size_t>> start;
+    std::vector<std::vector<int>> nbr;
+
+    size_t
+    num_layers(
+    ) const
+    {
+        return start.size();
+    }
+};
+
+/**
+ * Builds the core graph of the input layers (indices in idx.layers), in parallel.
+ */
+CoreGraph
+core_graph(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    size_t num_threads
+);
+
+/**
+ * Multilayer (k_1,...,k_L)-core restricted to the candidate actors: the largest subset
+ * of the candidates where each actor has at least k[l] neighbors in the subset on
+ * each layer l of g. Returns the sorted positions of its actors.
+ */
+std::vector<int>
+multilayer_core(
+    const CoreGraph& g,
+    const std::vector<size_t>& k,
+    const std::vector<int>& candidates
+);
+
+/**
+ * All the non-empty multilayer cores of g, ordered by sum of the k values and then
+ * lexicographically.
+ */
+struct MultilayerCores
+{
+    std::vector<std::vector<size_t>> k;
+    std::vector<size_t> size;
+};
+
+/**
+ * Computes all the non-empty multilayer cores, visiting the lattice of the k vectors
+ * breadth-first. As the core of k is contained in the cores of all the vectors
+ * obtained by decreasing one of its values, it is only computed if all of them are
+ * non-empty, and starting from the intersection of their actors. The cores at the
+ * same level of the lattice are computed in parallel.
+ */
+MultilayerCores
+multilayer_cores(
+    const CoreGraph& g,
+    size_t num_threads
+);
+
+#endif
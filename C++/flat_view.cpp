@@ -0,0 +1,157 @@
+#include "flat_view.h"
+#include "parallel.h"
+#include <memory>
+
+FlatView::FlatView(
+    const MLIndex& idx,
+    FlatWeight weight
+) : idx_(idx), weight_(weight), ordered_(idx.num_layers(), 1)
+{
+    for (size_t l = 0; l < idx.num_layers(); l++)
+    {
+        auto& actor = idx.layers[l].actor;
+
+        for (size_t i = 1; i < actor.size(); i++)
+        {
+            if (actor[i-1] >= actor[i])
+            {
+                ordered_[l] = 0;
+                break;
+            }
+        }
+    }
+}
+
+void
+FlatView::collect(
+    int a,
+    Buffer& buffer
+) const
+{
+    buffer.runs.clear();
+    buffer.sorted.clear();
+
+    // lists to be sorted are copied to buffer.sorted, reserved in advance so that the
+    // runs can point into it
+    size_t to_copy = 0;
+
+    for (size_t l = 0; l < idx_.num_layers(); l++)
+    {
+        int v = idx_.vertex_of[l][a];
+
+        if (v >= 0 && !ordered_[l])
+        {
+            auto& li = idx_.layers[l];
+            to_copy += li.out_end(v) - li.out_begin(v);
+
+            if (li.directed)
+            {
+                to_copy += li.in_end(v) - li.in_begin(v);
+            }
+        }
+    }
+
+    buffer.sorted.reserve(to_copy);
+
+    for (size_t l = 0; l < idx_.num_layers(); l++)
+    {
+        int v = idx_.vertex_of[l][a];
+
+        if (v < 0)
+        {
+            continue;
+        }
+
+        auto& li = idx_.layers[l];
+        size_t num_lists = li.directed ? 2 : 1;
+
+        for (size_t k = 0; k < num_lists; k++)
+        {
+            const int* begin = k == 0 ? li.out_begin(v) : li.in_begin(v);
+            const int* end = k == 0 ? li.out_end(v) : li.in_end(v);
+            Run run;
+            run.layer = l;
+
+            if (ordered_[l])
+            {
+                run.begin = begin;
+                run.end = end;
+                run.actor = li.actor.data();
+            }
+
+            else
+            {
+                size_t first = buffer.sorted.size();
+
+                for (auto p = begin; p != end; ++p)
+                {
+                    buffer.sorted.push_back(li.actor[*p]);
+                }
+
+                std::sort(buffer.sorted.begin() + first, buffer.sorted.end());
+                run.begin = buffer.sorted.data() + first;
+                run.end = buffer.sorted.data() + buffer.sorted.size();
+                run.actor = nullptr;
+            }
+
+            buffer.runs.push_back(run);
+        }
+    }
+}
+
+SupraPartition
+flat_louvain(
+    const MLIndex& idx,
+    FlatWeight weight,
+    size_t num_threads
+)
+{
+    FlatView view(idx, weight);
+    size_t n = view.num_actors();
+    std::vector<std::unique_ptr<FlatView::Buffer>> buffers(num_threads);
+
+    auto buffer = [&](size_t t) -> FlatView::Buffer&
+    {
+        if (!buffers[t])
+        {
+            buffers[t].reset(new FlatView::Buffer());
+        }
+
+        return *buffers[t];
+    };
+
+    // the flattened graph is only stored in the format used by the louvain method,
+    // in two passes over the view
+
+    std::vector<size_t> start(n + 1, 0);
+
+    parallel_for(n, num_threads, [&](size_t a, size_t t)
+    {
+        view.for_each_neighbor(a, buffer(t), [&](int, double)
+        {
+            start[a + 1]++;
+        });
+    }, 256);
+
+    for (size_t a = 0; a < n; a++)
+    {
+        start[a+1] += start[a];
+    }
+
+    std::vector<int> nbr(start[n]);
+    std::vector<double> w(start[n]);
+
+    parallel_for(n, num_threads, [&](size_t a, size_t t)
+    {
+        size_t p = start[a];
+
+        view.for_each_neighbor(a, buffer(t), [&](int b, double x)
+        {
+            nbr[p] = b;
+            w[p] = x;
+            p++;
+        });
+    }, 256);
+
+    return louvain(std::move(start), std::move(nbr), std::move(w), 1.0, true, num_threads);
+}
@@ -0,0 +1,189 @@
+#ifndef UU_R_MULTINET_FLAT_VIEW_H_
+#define UU_R_MULTINET_FLAT_VIEW_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "glouvain.h"
+#include "ml_index.h"
+
+/**
+ * Weights of the edges of a flattened network.
+ */
+enum class FlatWeight
+{
+    // 1 for each pair of adjacent actors
+    UNWEIGHTED,
+    // number of layers where the two actors are adjacent
+    EDGE_COUNT
+};
+
+/**
+ * Flattened view of the layers of an index: actors are adjacent if their vertices are
+ * adjacent on at least one layer, ignoring edge directionality and self-loops.
+ *
+ * The flattened graph is not stored: the neighbors of an actor are computed when
+ * requested, merging its sorted neighbor lists on all layers (k-way merge). Lists are
+ * read directly from the layer indices when vertices are stored in the order of their
+ * actors, which is the common case, and are otherwise copied and sorted by actor.
+ */
+class FlatView
+{
+  public:
+
+    // sorted neighbor list on one layer: vertex positions, mapped to actors by actor,
+    // or actor positions if actor is nullptr
+    struct Run
+    {
+        const int* begin;
+        const int* end;
+        const int* actor;
+        int layer;
+
+        int
+        front(
+        ) const
+        {
+            return actor ? actor[*begin] : *begin;
+        }
+    };
+
+    // working memory of for_each_neighbor(), to be reused between calls
+    struct Buffer
+    {
+        std::vector<Run> runs;
+        std::vector<int> sorted;
+        std::vector<std::pair<int, int>> heap;
+    };
+
+    FlatView(
+        const MLIndex& idx,
+        FlatWeight weight
+    );
+
+    size_t
+    num_actors(
+    ) const
+    {
+        return idx_.num_actors();
+    }
+
+    /**
+     * Calls f(b, w) for each neighbor b of actor a, in increasing order of b, where w
+     * is the weight of the edge.
+     */
+    template <typename F>
+    void
+    for_each_neighbor(
+        int a,
+        Buffer& buffer,
+        F f
+    ) const;
+
+  private:
+
+    // neighbor lists of a on each layer, as runs of actor positions
+    void
+    collect(
+        int a,
+        Buffer& buffer
+    ) const;
+
+    const MLIndex& idx_;
+    FlatWeight weight_;
+
+    // true for the layers where the actors of the vertices are increasing
+    std::vector<char> ordered_;
+};
+
+template <typename F>
+void
+FlatView::for_each_neighbor(
+    int a,
+    Buffer& buffer,
+    F f
+) const
+{
+    collect(a, buffer);
+
+    auto& runs = buffer.runs;
+    auto& heap = buffer.heap;
+    heap.clear();
+
+    // min-heap of (actor, run); runs of the same layer are consecutive, so equal
+    // actors from the same layer are extracted one after the other
+    auto greater = [](const std::pair<int, int>& x, const std::pair<int, int>& y)
+    {
+        return x > y;
+    };
+
+    for (size_t r = 0; r < runs.size(); r++)
+    {
+        if (runs[r].begin != runs[r].end)
+        {
+            heap.push_back(std::make_pair(runs[r].front(), (int)r));
+        }
+    }
+
+    std::make_heap(heap.begin(), heap.end(), greater);
+
+    int current = -1;
+    int last_layer = -1;
+    double w = 0;
+
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        int b = heap.back().first;
+        int r = heap.back().second;
+        heap.pop_back();
+
+        if (++runs[r].begin != runs[r].end)
+        {
+            heap.push_back(std::make_pair(runs[r].front(), r));
+            std::push_heap(heap.begin(), heap.end(), greater);
+        }
+
+        if (b == a)
+        {
+            continue;
+        }
+
+        if (b != current)
+        {
+            if (current >= 0)
+            {
+                f(current, w);
+            }
+
+            current = b;
+            last_layer = -1;
+            w = 0;
+        }
+
+        if (runs[r].layer != last_layer)
+        {
+            last_layer = runs[r].layer;
+            w = weight_ == FlatWeight::EDGE_COUNT ? w + 1 : 1;
+        }
+    }
+
+    if (current >= 0)
+    {
+        f(current, w);
+    }
+}
+
+/**
+ * Communities of the flattened network computed with the louvain method, reading the
+ * flattened graph from a FlatView in parallel. Membership is indexed by actor.
+ */
+SupraPartition
+flat_louvain(
+    const MLIndex& idx,
+    FlatWeight weight,
+    size_t num_threads
+);
+
+#endif
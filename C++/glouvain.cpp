@@ -0,0 +1,1506 @@
+#include "glouvain.h"
+#include "parallel.h"
+#include "core/exceptions/WrongParameterException.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace {
+
+// sweeps of the local-moving phase stop when the modularity increases less than this
+const double kMinGain = 1e-7;
+const size_t kMaxSweeps = 100;
+
+// vertices (or communities) per task when partial results are reduced in order
+const size_t kChunkSize = 1024;
+
+// finalizer of splitmix64
+uint64_t
+mix64(
+    uint64_t x
+)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/**
+ * Weighted graph of one level of the algorithm. At the first level vertices are the
+ * vertices of the network, arcs are the (symmetric) intralayer edges, and couplings
+ * with weight omega between the vertices of the same actor are implicit, so that
+ * memory is linear in the number of edges and vertices; at the next levels vertices
+ * are the communities of the previous level, and couplings are merged into the arcs.
+ */
+struct SupraGraph
+{
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+    std::vector<double> weight;
+
+    // implicit couplings (first level only): vertices of each actor in layer order,
+    // with the actor, layer and position in actor_vertex of each vertex
+    Coupling coupling = Coupling::CATEGORICAL;
+    std::vector<size_t> actor_start;
+    std::vector<int> actor_vertex;
+    std::vector<int> vertex_actor;
+    std::vector<int> vertex_layer;
+    std::vector<size_t> actor_pos;
+
+    // weight of the arcs between the vertices merged into each vertex
+    std::vector<double> self_weight;
+
+    // intralayer strength of each vertex on each layer where it is non-zero
+    std::vector<size_t> strength_start;
+    std::vector<int> strength_layer;
+    std::vector<double> strength;
+
+    size_t
+    num_vertices(
+    ) const
+    {
+        return self_weight.size();
+    }
+
+    // f(u, w) for each arc from v to u with weight w, including the couplings with
+    // weight omega
+    template <typename F>
+    void
+    for_each_arc(
+        size_t v,
+        double omega,
+        F f
+    ) const
+    {
+        for (size_t p = start[v]; p < start[v+1]; p++)
+        {
+            f(nbr[p], weight[p]);
+        }
+
+        if (omega == 0 || actor_pos.empty())
+        {
+            return;
+        }
+
+        size_t first = actor_start[vertex_actor[v]];
+        size_t last = actor_start[vertex_actor[v] + 1];
+
+        if (coupling == Coupling::CATEGORICAL)
+        {
+            for (size_t p = first; p < last; p++)
+            {
+                if (p != actor_pos[v])
+                {
+                    f(actor_vertex[p], omega);
+                }
+            }
+
+            return;
+        }
+
+        // ordinal: the vertices of the actor on the previous and next layers
+        size_t p = actor_pos[v];
+
+        if (p > first && vertex_layer[actor_vertex[p-1]] + 1 == vertex_layer[v])
+        {
+            f(actor_vertex[p-1], omega);
+        }
+
+        if (p + 1 < last && vertex_layer[actor_vertex[p+1]] == vertex_layer[v] + 1)
+        {
+            f(actor_vertex[p+1], omega);
+        }
+    }
+};
+
+/**
+ * Strength of each community on each layer, in a lock-free hash table with
+ * capacity fixed at construction.
+ */
+class LayerTotals
+{
+  public:
+
+    LayerTotals(
+        size_t num_layers,
+        size_t capacity
+    ) : num_layers_(num_layers)
+    {
+        size_t size = 16;
+
+        while (size < 2 * capacity)
+        {
+            size *= 2;
+        }
+
+        mask_ = size - 1;
+        keys_.reset(new std::atomic<uint64_t>[size]);
+        values_.reset(new std::atomic<double>[size]);
+
+        for (size_t i = 0; i < size; i++)
+        {
+            keys_[i].store(kEmpty, std::memory_order_relaxed);
+            values_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void
+    add(
+        int community,
+        int layer,
+        double delta
+    )
+    {
+        uint64_t key = (uint64_t)community * num_layers_ + layer;
+
+        for (size_t i = slot(key); ; i = (i + 1) & mask_)
+        {
+            uint64_t k = keys_[i].load(std::memory_order_acquire);
+
+            // on failure, k is the key inserted by another thread
+            if (k == kEmpty && keys_[i].compare_exchange_strong(k, key))
+            {
+                k = key;
+            }
+
+            if (k != key)
+            {
+                continue;
+            }
+
+            double value = values_[i].load(std::memory_order_relaxed);
+
+            while (!values_[i].compare_exchange_weak(value, value + delta, std::memory_order_relaxed))
+            {
+            }
+
+            return;
+        }
+    }
+
+    double
+    get(
+        int community,
+        int layer
+    ) const
+    {
+        uint64_t key = (uint64_t)community * num_layers_ + layer;
+
+        for (size_t i = slot(key); ; i = (i + 1) & mask_)
+        {
+            uint64_t k = keys_[i].load(std::memory_order_acquire);
+
+            if (k == key)
+            {
+                return values_[i].load(std::memory_order_relaxed);
+            }
+
+            if (k == kEmpty)
+            {
+                return 0;
+            }
+        }
+    }
+
+    // f(community, layer, value) for each entry, in slot order
+    template <typename F>
+    void
+    for_each(
+        F f
+    ) const
+    {
+        for (size_t i = 0; i <= mask_; i++)
+        {
+            uint64_t k = keys_[i].load(std::memory_order_relaxed);
+
+            if (k != kEmpty)
+            {
+                f(k / num_layers_, k % num_layers_, values_[i].load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+  private:
+
+    static const uint64_t kEmpty = ~(uint64_t)0;
+
+    size_t
+    slot(
+        uint64_t key
+    ) const
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key & mask_;
+    }
+
+    size_t num_layers_;
+    size_t mask_;
+    std::unique_ptr<std::atomic<uint64_t>[]> keys_;
+    std::unique_ptr<std::atomic<double>[]> values_;
+};
+
+// sorts (key, value) pairs by key and sums the values with the same key
+template <typename K>
+void
+merge_pairs(
+    std::vector<std::pair<K, double>>& pairs
+)
+{
+    std::sort(pairs.begin(), pairs.end(), [](const std::pair<K, double>& a, const std::pair<K, double>& b)
+    {
+        return a.first < b.first;
+    });
+
+    size_t q = 0;
+
+    for (size_t p = 0; p < pairs.size(); p++)
+    {
+        if (q > 0 && pairs[q-1].first == pairs[p].first)
+        {
+            pairs[q-1].second += pairs[p].second;
+        }
+
+        else
+        {
+            pairs[q++] = pairs[p];
+        }
+    }
+
+    pairs.resize(q);
+}
+
+template <typename S>
+double
+edge_weight(
+    const S* attributes,
+    const uu::net::Edge* edge,
+    bool weighted
+)
+{
+    if (!weighted)
+    {
+        return 1;
+    }
+
+    auto value = attributes->get_double(edge, "w_");
+
+    if (value.null)
+    {
+        return 1;
+    }
+
+    if (!(value.value >= 0) || std::isinf(value.value))
+    {
+        throw uu::core::WrongParameterException("edge weights must be non-negative numbers");
+    }
+
+    return value.value;
+}
+
+SupraGraph
+first_level(
+    const MLIndex& idx,
+    Coupling coupling,
+    std::vector<double>& layer_weight,
+    size_t num_threads
+)
+{
+    size_t n = idx.num_vertices;
+    size_t L = idx.num_layers();
+
+    // weights are used only if all layers have them
+    bool weighted = L > 0;
+
+    for (auto& li: idx.layers)
+    {
+        auto att = li.layer->edges()->attr()->get("w_");
+        weighted = weighted && att && att->type == uu::core::AttributeType::DOUBLE;
+    }
+
+    // intralayer arcs, in two passes over the edges to avoid an intermediate edge list
+
+    std::vector<size_t> start(n + 1, 0);
+
+    for (auto& li: idx.layers)
+    {
+        auto vertices = li.layer->vertices();
+
+        for (auto edge: *li.layer->edges())
+        {
+            int v1 = li.offset + vertices->index_of(edge->v1);
+            int v2 = li.offset + vertices->index_of(edge->v2);
+
+            if (v1 != v2)
+            {
+                start[v1 + 1]++;
+                start[v2 + 1]++;
+            }
+        }
+    }
+
+    for (size_t v = 0; v < n; v++)
+    {
+        start[v+1] += start[v];
+    }
+
+    std::vector<std::pair<int, double>> arcs(start[n]);
+    std::vector<size_t> pos(start.begin(), start.end() - 1);
+
+    for (auto& li: idx.layers)
+    {
+        auto vertices = li.layer->vertices();
+        auto attributes = li.layer->edges()->attr();
+
+        for (auto edge: *li.layer->edges())
+        {
+            int v1 = li.offset + vertices->index_of(edge->v1);
+            int v2 = li.offset + vertices->index_of(edge->v2);
+
+            if (v1 != v2)
+            {
+                double weight = edge_weight(attributes, edge, weighted);
+                arcs[pos[v1]++] = std::make_pair(v2, weight);
+                arcs[pos[v2]++] = std::make_pair(v1, weight);
+            }
+        }
+    }
+
+    SupraGraph g;
+    g.self_weight.assign(n, 0);
+
+    // parallel edges (in directed layers) are merged
+    std::vector<size_t> length(n);
+    std::vector<double> k(n, 0);
+
+    parallel_for(n, num_threads, [&](size_t v, size_t)
+    {
+        std::sort(arcs.begin() + start[v], arcs.begin() + start[v+1]);
+        size_t q = start[v];
+
+        for (size_t p = start[v]; p < start[v+1]; p++)
+        {
+            k[v] += arcs[p].second;
+
+            if (q > start[v] && arcs[q-1].first == arcs[p].first)
+            {
+                arcs[q-1].second += arcs[p].second;
+            }
+
+            else
+            {
+                arcs[q++] = arcs[p];
+            }
+        }
+
+        length[v] = q - start[v];
+    }, 1024);
+
+    g.start.assign(n + 1, 0);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        g.start[v+1] = g.start[v] + length[v];
+    }
+
+    g.nbr.resize(g.start[n]);
+    g.weight.resize(g.start[n]);
+
+    parallel_for(n, num_threads, [&](size_t v, size_t)
+    {
+        for (size_t i = 0; i < length[v]; i++)
+        {
+            g.nbr[g.start[v] + i] = arcs[start[v] + i].first;
+            g.weight[g.start[v] + i] = arcs[start[v] + i].second;
+        }
+    }, 1024);
+
+    std::vector<std::pair<int, double>>().swap(arcs);
+
+    // couplings are not stored: each vertex only records its actor and layer
+
+    g.coupling = coupling;
+    g.vertex_actor.resize(n);
+    g.vertex_layer.resize(n);
+    g.actor_start.assign(idx.num_actors() + 1, 0);
+
+    for (size_t l = 0; l < L; l++)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t i = 0; i < li.num_vertices(); i++)
+        {
+            g.vertex_actor[li.offset + i] = li.actor[i];
+            g.vertex_layer[li.offset + i] = l;
+            g.actor_start[li.actor[i] + 1]++;
+        }
+    }
+
+    for (size_t a = 0; a < idx.num_actors(); a++)
+    {
+        g.actor_start[a+1] += g.actor_start[a];
+    }
+
+    // vertices of each actor in layer order, as the vertices are numbered by layer
+    std::vector<size_t> next(g.actor_start.begin(), g.actor_start.end() - 1);
+    g.actor_vertex.resize(n);
+    g.actor_pos.resize(n);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        g.actor_pos[v] = next[g.vertex_actor[v]]++;
+        g.actor_vertex[g.actor_pos[v]] = v;
+    }
+
+    layer_weight.assign(L, 0);
+    g.strength_start.assign(1, 0);
+
+    for (size_t l = 0; l < L; l++)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t i = 0; i < li.num_vertices(); i++)
+        {
+            double s = k[li.offset + i];
+
+            if (s > 0)
+            {
+                g.strength_layer.push_back(l);
+                g.strength.push_back(s);
+                layer_weight[l] += s;
+            }
+
+            g.strength_start.push_back(g.strength.size());
+        }
+    }
+
+    return g;
+}
+
+/**
+ * Community of each vertex of a level, with the strength on each layer of each community.
+ */
+class LevelState
+{
+  public:
+
+    // each vertex starts in its own community, or in community initial[v] (< number of vertices)
+    LevelState(
+        const SupraGraph& g,
+        const std::vector<double>& layer_weight,
+        double gamma,
+        double omega,
+        const std::vector<int>& initial,
+        size_t num_threads
+    ) : g_(g), layer_weight_(layer_weight), gamma_(gamma), omega_(omega), num_threads_(num_threads),
+        label_(new std::atomic<int>[g.num_vertices()]), buffers_(num_threads)
+    {
+        for (size_t v = 0; v < g.num_vertices(); v++)
+        {
+            label_[v].store(initial.empty() ? v : initial[v], std::memory_order_relaxed);
+        }
+
+        rebuild_totals();
+    }
+
+    const SupraGraph&
+    graph(
+    ) const
+    {
+        return g_;
+    }
+
+    double
+    omega(
+    ) const
+    {
+        return omega_;
+    }
+
+    int
+    label(
+        size_t v
+    ) const
+    {
+        return label_[v].load(std::memory_order_relaxed);
+    }
+
+    // best community for v in the current state
+    int
+    best_community(
+        size_t v,
+        size_t thread_id
+    )
+    {
+        auto& weights = buffers_[thread_id];
+        weights.clear();
+
+        int own = label(v);
+
+        g_.for_each_arc(v, omega_, [&](int u, double w)
+        {
+            weights.push_back(std::make_pair(label(u), w));
+        });
+
+        merge_pairs(weights);
+
+        double own_weight = 0;
+
+        for (auto& c: weights)
+        {
+            if (c.first == own)
+            {
+                own_weight = c.second;
+            }
+        }
+
+        int best = own;
+        double best_gain = own_weight - null_term(v, own, true);
+
+        for (auto& c: weights)
+        {
+            if (c.first == own)
+            {
+                continue;
+            }
+
+            double gain = c.second - null_term(v, c.first, false);
+
+            if (gain > best_gain)
+            {
+                best = c.first;
+                best_gain = gain;
+            }
+        }
+
+        return best;
+    }
+
+    void
+    move(
+        size_t v,
+        int community
+    )
+    {
+        int old = label(v);
+        label_[v].store(community, std::memory_order_relaxed);
+
+        for (size_t p = g_.strength_start[v]; p < g_.strength_start[v+1]; p++)
+        {
+            totals_->add(old, g_.strength_layer[p], -g_.strength[p]);
+            totals_->add(community, g_.strength_layer[p], g_.strength[p]);
+        }
+    }
+
+    /**
+     * Recomputes the community strengths (sequentially, so that the result does not
+     * depend on the order of the previous updates) with room for one move per vertex.
+     */
+    void
+    rebuild_totals(
+    )
+    {
+        totals_.reset(new LayerTotals(layer_weight_.size(), 2 * g_.strength.size()));
+
+        for (size_t v = 0; v < g_.num_vertices(); v++)
+        {
+            for (size_t p = g_.strength_start[v]; p < g_.strength_start[v+1]; p++)
+            {
+                totals_->add(label(v), g_.strength_layer[p], g_.strength[p]);
+            }
+        }
+    }
+
+    // modularity, not normalized; totals must have been rebuilt after the last moves
+    double
+    quality(
+    ) const
+    {
+        size_t n = g_.num_vertices();
+        size_t num_chunks = (n + kChunkSize - 1) / kChunkSize;
+        std::vector<double> partial(num_chunks, 0);
+
+        parallel_for(num_chunks, num_threads_, [&](size_t chunk, size_t)
+        {
+            size_t end = std::min(n, (chunk + 1) * kChunkSize);
+
+            for (size_t v = chunk * kChunkSize; v < end; v++)
+            {
+                partial[chunk] += g_.self_weight[v];
+
+                g_.for_each_arc(v, omega_, [&](int u, double w)
+                {
+                    if (label(u) == label(v))
+                    {
+                        partial[chunk] += w;
+                    }
+                });
+            }
+        });
+
+        double q = 0;
+
+        for (auto s: partial)
+        {
+            q += s;
+        }
+
+        totals_->for_each([&](size_t, size_t l, double value)
+        {
+            if (layer_weight_[l] > 0)
+            {
+                q -= gamma_ * value * value / layer_weight_[l];
+            }
+        });
+
+        return q;
+    }
+
+  private:
+
+    // expected weight between v and community c on the layers of v, excluding v itself
+    double
+    null_term(
+        size_t v,
+        int c,
+        bool own
+    ) const
+    {
+        double res = 0;
+
+        for (size_t p = g_.strength_start[v]; p < g_.strength_start[v+1]; p++)
+        {
+            int l = g_.strength_layer[p];
+            double total = totals_->get(c, l) - (own ? g_.strength[p] : 0);
+            res += g_.strength[p] * total / layer_weight_[l];
+        }
+
+        return gamma_ * res;
+    }
+
+    const SupraGraph& g_;
+    const std::vector<double>& layer_weight_;
+    double gamma_;
+    double omega_;
+    size_t num_threads_;
+    std::unique_ptr<std::atomic<int>[]> label_;
+    std::unique_ptr<LayerTotals> totals_;
+    std::vector<std::vector<std::pair<int, double>>> buffers_;
+};
+
+/**
+ * Greedy coloring of the vertices in order, so that adjacent vertices have different
+ * colors. The vertices of each color are listed in order in vertex, from class_start[c].
+ */
+void
+color_classes(
+    const SupraGraph& g,
+    double omega,
+    std::vector<size_t>& class_start,
+    std::vector<int>& vertex
+)
+{
+    size_t n = g.num_vertices();
+    std::vector<int> color(n, -1);
+    std::vector<size_t> used;
+    size_t num_colors = 0;
+
+    for (size_t v = 0; v < n; v++)
+    {
+        g.for_each_arc(v, omega, [&](int u, double)
+        {
+            if (color[u] >= 0)
+            {
+                used[color[u]] = v + 1;
+            }
+        });
+
+        size_t c = 0;
+
+        while (c < num_colors && used[c] == v + 1)
+        {
+            c++;
+        }
+
+        if (c == num_colors)
+        {
+            used.push_back(0);
+            num_colors++;
+        }
+
+        color[v] = c;
+    }
+
+    class_start.assign(num_colors + 1, 0);
+
+    for (auto c: color)
+    {
+        class_start[c + 1]++;
+    }
+
+    for (size_t c = 0; c < num_colors; c++)
+    {
+        class_start[c+1] += class_start[c];
+    }
+
+    std::vector<size_t> pos(class_start.begin(), class_start.end() - 1);
+    vertex.resize(n);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        vertex[pos[color[v]]++] = v;
+    }
+}
+
+// local-moving phase; returns the (not normalized) modularity of the result. If not
+// empty, order is the order in which the vertices are visited when not deterministic
+double
+local_moving(
+    LevelState& state,
+    bool deterministic,
+    const std::vector<int>& order,
+    size_t num_threads
+)
+{
+    size_t n = state.graph().num_vertices();
+    double q = state.quality();
+    std::vector<size_t> class_start;
+    std::vector<int> vertex;
+    std::vector<int> target;
+
+    if (deterministic)
+    {
+        color_classes(state.graph(), state.omega(), class_start, vertex);
+        target.resize(n);
+    }
+
+    for (size_t sweep = 0; sweep < kMaxSweeps; sweep++)
+    {
+        std::atomic<size_t> moved(0);
+
+        if (deterministic)
+        {
+            // the vertices of a class are not adjacent, so their moves do not change
+            // the weights to the communities seen by the others
+            for (size_t c = 0; c + 1 < class_start.size(); c++)
+            {
+                size_t begin = class_start[c];
+
+                parallel_for(class_start[c+1] - begin, num_threads, [&](size_t i, size_t t)
+                {
+                    target[begin + i] = state.best_community(vertex[begin + i], t);
+                }, 64);
+
+                for (size_t i = begin; i < class_start[c+1]; i++)
+                {
+                    if (target[i] != state.label(vertex[i]))
+                    {
+                        state.move(vertex[i], target[i]);
+                        moved++;
+                    }
+                }
+            }
+        }
+
+        else
+        {
+            parallel_for(n, num_threads, [&](size_t i, size_t t)
+            {
+                int v = order.empty() ? i : order[i];
+                int c = state.best_community(v, t);
+
+                if (c != state.label(v))
+                {
+                    state.move(v, c);
+                    moved++;
+                }
+            }, 64);
+        }
+
+        if (moved == 0)
+        {
+            break;
+        }
+
+        state.rebuild_totals();
+        double previous = q;
+        q = state.quality();
+
+        if (q - previous < kMinGain * std::abs(previous) + kMinGain)
+        {
+            break;
+        }
+    }
+
+    return q;
+}
+
+// graph of the communities, numbered from 0 to num_communities-1 in label
+SupraGraph
+aggregate(
+    const SupraGraph& g,
+    double omega,
+    const std::vector<int>& label,
+    size_t num_communities,
+    size_t num_threads
+)
+{
+    size_t n = g.num_vertices();
+    std::vector<size_t> member_start(num_communities + 1, 0);
+
+    for (auto c: label)
+    {
+        member_start[c + 1]++;
+    }
+
+    for (size_t c = 0; c < num_communities; c++)
+    {
+        member_start[c+1] += member_start[c];
+    }
+
+    std::vector<int> members(n);
+    std::vector<size_t> pos(member_start.begin(), member_start.end() - 1);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        members[pos[label[v]]++] = v;
+    }
+
+    struct Chunk
+    {
+        std::vector<size_t> num_arcs;
+        std::vector<std::pair<int, double>> arcs;
+        std::vector<size_t> num_strengths;
+        std::vector<std::pair<int, double>> strengths;
+    };
+
+    size_t num_chunks = (num_communities + kChunkSize - 1) / kChunkSize;
+    std::vector<Chunk> chunks(num_chunks);
+
+    SupraGraph res;
+    res.self_weight.assign(num_communities, 0);
+
+    parallel_for(num_chunks, num_threads, [&](size_t chunk, size_t)
+    {
+        auto& out = chunks[chunk];
+        size_t end = std::min(num_communities, (chunk + 1) * kChunkSize);
+        std::vector<std::pair<int, double>> arcs, strengths;
+
+        for (size_t c = chunk * kChunkSize; c < end; c++)
+        {
+            arcs.clear();
+            strengths.clear();
+
+            for (size_t i = member_start[c]; i < member_start[c+1]; i++)
+            {
+                int v = members[i];
+                res.self_weight[c] += g.self_weight[v];
+
+                g.for_each_arc(v, omega, [&](int u, double w)
+                {
+                    if (label[u] == (int)c)
+                    {
+                        res.self_weight[c] += w;
+                    }
+
+                    else
+                    {
+                        arcs.push_back(std::make_pair(label[u], w));
+                    }
+                });
+
+                for (size_t p = g.strength_start[v]; p < g.strength_start[v+1]; p++)
+                {
+                    strengths.push_back(std::make_pair(g.strength_layer[p], g.strength[p]));
+                }
+            }
+
+            merge_pairs(arcs);
+            merge_pairs(strengths);
+            out.num_arcs.push_back(arcs.size());
+            out.arcs.insert(out.arcs.end(), arcs.begin(), arcs.end());
+            out.num_strengths.push_back(strengths.size());
+            out.strengths.insert(out.strengths.end(), strengths.begin(), strengths.end());
+        }
+    });
+
+    res.start.assign(1, 0);
+    res.strength_start.assign(1, 0);
+    std::vector<size_t> arc_offset(num_chunks + 1, 0);
+    std::vector<size_t> strength_offset(num_chunks + 1, 0);
+
+    for (size_t chunk = 0; chunk < num_chunks; chunk++)
+    {
+        for (auto k: chunks[chunk].num_arcs)
+        {
+            res.start.push_back(res.start.back() + k);
+        }
+
+        for (auto k: chunks[chunk].num_strengths)
+        {
+            res.strength_start.push_back(res.strength_start.back() + k);
+        }
+
+        arc_offset[chunk + 1] = arc_offset[chunk] + chunks[chunk].arcs.size();
+        strength_offset[chunk + 1] = strength_offset[chunk] + chunks[chunk].strengths.size();
+    }
+
+    res.nbr.resize(arc_offset[num_chunks]);
+    res.weight.resize(arc_offset[num_chunks]);
+    res.strength_layer.resize(strength_offset[num_chunks]);
+    res.strength.resize(strength_offset[num_chunks]);
+
+    parallel_for(num_chunks, num_threads, [&](size_t chunk, size_t)
+    {
+        auto& in = chunks[chunk];
+
+        for (size_t i = 0; i < in.arcs.size(); i++)
+        {
+            res.nbr[arc_offset[chunk] + i] = in.arcs[i].first;
+            res.weight[arc_offset[chunk] + i] = in.arcs[i].second;
+        }
+
+        for (size_t i = 0; i < in.strengths.size(); i++)
+        {
+            res.strength_layer[strength_offset[chunk] + i] = in.strengths[i].first;
+            res.strength[strength_offset[chunk] + i] = in.strengths[i].second;
+        }
+
+        std::vector<std::pair<int, double>>().swap(in.arcs);
+        std::vector<std::pair<int, double>>().swap(in.strengths);
+    });
+
+    return res;
+}
+
+// numbers the labels from 0 in order of their first vertex; returns the number of labels
+size_t
+renumber(
+    std::vector<int>& label
+)
+{
+    std::vector<int> id(label.size(), -1);
+    size_t num_labels = 0;
+
+    for (auto& c: label)
+    {
+        if (id[c] < 0)
+        {
+            id[c] = num_labels++;
+        }
+
+        c = id[c];
+    }
+
+    return num_labels;
+}
+
+// random permutation of 0, ..., n-1 (Fisher-Yates), drawn from seed
+std::vector<int>
+random_order(
+    size_t n,
+    uint64_t seed
+)
+{
+    std::vector<int> order(n);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        order[i] = i;
+    }
+
+    for (size_t i = n; i > 1; i--)
+    {
+        size_t j = mix64(seed ^ mix64(i)) % i;
+        std::swap(order[i-1], order[j]);
+    }
+
+    return order;
+}
+
+// runs the algorithm from the first level, base; if shuffle is true, the vertices of
+// each level are visited in a random order drawn from seed
+SupraPartition
+optimize(
+    const SupraGraph& base,
+    const std::vector<double>& layer_weight,
+    double gamma,
+    double omega,
+    bool deterministic,
+    const std::vector<int>& initial,
+    bool shuffle,
+    uint64_t seed,
+    size_t num_threads
+)
+{
+    size_t n0 = base.num_vertices();
+
+    // total weight, including the couplings
+    double total = 0;
+
+    for (size_t v = 0; v < n0; v++)
+    {
+        base.for_each_arc(v, omega, [&](int, double w)
+        {
+            total += w;
+        });
+    }
+
+    SupraPartition res;
+    res.membership.resize(n0);
+
+    for (size_t v = 0; v < n0; v++)
+    {
+        res.membership[v] = v;
+    }
+
+    // the first level is shared by all runs; the next ones are built here
+    const SupraGraph* g = &base;
+    SupraGraph level;
+    double q = 0;
+
+    for (size_t depth = 0; ; depth++)
+    {
+        size_t n = g->num_vertices();
+        LevelState state(*g, layer_weight, gamma, omega, g == &base ? initial : std::vector<int>(), num_threads);
+        auto order = shuffle ? random_order(n, mix64(seed + depth)) : std::vector<int>();
+        q = local_moving(state, deterministic, order, num_threads);
+
+        std::vector<int> label(n);
+
+        for (size_t v = 0; v < n; v++)
+        {
+            label[v] = state.label(v);
+        }
+
+        size_t num_communities = renumber(label);
+
+        for (auto& c: res.membership)
+        {
+            c = label[c];
+        }
+
+        if (num_communities == n)
+        {
+            break;
+        }
+
+        SupraGraph next = aggregate(*g, omega, label, num_communities, num_threads);
+        level = std::move(next);
+        g = &level;
+    }
+
+    res.num_communities = renumber(res.membership);
+    res.modularity = total > 0 ? q / total : 0;
+    return res;
+}
+
+// first level of a weighted graph in CSR format: a single layer, without couplings
+SupraGraph
+single_layer(
+    std::vector<size_t>& start,
+    std::vector<int>& nbr,
+    std::vector<double>& weight,
+    std::vector<double>& layer_weight
+)
+{
+    SupraGraph g;
+    size_t n = start.size() - 1;
+    g.start.swap(start);
+    g.nbr.swap(nbr);
+    g.weight.swap(weight);
+    g.self_weight.assign(n, 0);
+
+    layer_weight.assign(1, 0);
+    g.strength_start.assign(1, 0);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        double s = 0;
+
+        for (size_t p = g.start[v]; p < g.start[v+1]; p++)
+        {
+            s += g.weight[p];
+        }
+
+        if (s > 0)
+        {
+            g.strength_layer.push_back(0);
+            g.strength.push_back(s);
+            layer_weight[0] += s;
+        }
+
+        g.strength_start.push_back(g.strength.size());
+    }
+
+    return g;
+}
+
+// throws if membership does not have one community identifier between 0 and n-1 for
+// each of the n vertices
+void
+check_partition(
+    const std::vector<int>& membership,
+    size_t n,
+    const std::string& name
+)
+{
+    if (membership.size() != n)
+    {
+        throw uu::core::WrongParameterException(name + " must contain all the vertices");
+    }
+
+    for (auto c: membership)
+    {
+        if (c < 0 || (size_t)c >= n)
+        {
+            throw uu::core::WrongParameterException("community identifiers must be between 0 and the number of vertices - 1");
+        }
+    }
+}
+
+}
+
+struct GeneralizedLouvain::Graph
+{
+    SupraGraph g;
+
+    // vertices of layer l: layer_start[l], ..., layer_start[l+1]-1
+    std::vector<size_t> layer_start;
+
+    // total weight of the arcs, and number of couplings (each weighted omega)
+    double arc_weight;
+    double num_couplings;
+};
+
+GeneralizedLouvain::GeneralizedLouvain(
+    const MLIndex& idx,
+    Coupling coupling,
+    size_t num_threads
+) : graph_(new Graph)
+{
+    graph_->g = first_level(idx, coupling, layer_weight_, num_threads);
+
+    auto& g = graph_->g;
+    graph_->layer_start.resize(idx.num_layers() + 1);
+
+    for (size_t l = 0; l < idx.num_layers(); l++)
+    {
+        graph_->layer_start[l] = idx.layers[l].offset;
+    }
+
+    graph_->layer_start[idx.num_layers()] = g.num_vertices();
+    graph_->arc_weight = 0;
+    graph_->num_couplings = 0;
+
+    for (size_t v = 0; v < g.num_vertices(); v++)
+    {
+        size_t num_arcs = 0;
+
+        g.for_each_arc(v, 1, [&](int, double)
+        {
+            num_arcs++;
+        });
+
+        graph_->num_couplings += num_arcs - (g.start[v+1] - g.start[v]);
+    }
+
+    for (auto w: g.weight)
+    {
+        graph_->arc_weight += w;
+    }
+}
+
+GeneralizedLouvain::GeneralizedLouvain(
+    std::vector<size_t> start,
+    std::vector<int> nbr,
+    std::vector<double> weight
+) : graph_(new Graph)
+{
+    graph_->g = single_layer(start, nbr, weight, layer_weight_);
+    graph_->layer_start.assign(1, 0);
+    graph_->layer_start.push_back(graph_->g.num_vertices());
+    graph_->arc_weight = layer_weight_[0];
+    graph_->num_couplings = 0;
+}
+
+GeneralizedLouvain::~GeneralizedLouvain(
+)
+{
+}
+
+size_t
+GeneralizedLouvain::num_vertices(
+) const
+{
+    return graph_->g.num_vertices();
+}
+
+SupraPartition
+GeneralizedLouvain::run(
+    double gamma,
+    double omega,
+    bool deterministic,
+    const std::vector<int>& initial,
+    size_t num_threads
+) const
+{
+    if (!initial.empty())
+    {
+        check_partition(initial, graph_->g.num_vertices(), "the initial partition");
+    }
+
+    return optimize(graph_->g, layer_weight_, gamma, omega, deterministic, initial, false, 0, num_threads);
+}
+
+SupraPartition
+GeneralizedLouvain::run_randomized(
+    double gamma,
+    double omega,
+    uint64_t seed
+) const
+{
+    return optimize(graph_->g, layer_weight_, gamma, omega, false, std::vector<int>(), true, seed, 1);
+}
+
+double
+GeneralizedLouvain::modularity(
+    const std::vector<int>& membership,
+    double gamma,
+    double omega,
+    size_t num_threads
+) const
+{
+    const SupraGraph& g = graph_->g;
+    size_t n = g.num_vertices();
+    size_t L = layer_weight_.size();
+
+    check_partition(membership, n, "the partition");
+
+    // each layer is processed by one task, summing the strengths of its communities in
+    // a dense array of the thread
+    std::vector<std::vector<double>> strengths(num_threads);
+    std::vector<std::vector<int>> touched(num_threads);
+    std::vector<double> partial(L, 0);
+
+    parallel_for(L, num_threads, [&](size_t l, size_t t)
+    {
+        auto& K = strengths[t];
+        K.resize(n, 0);
+        double internal = 0;
+
+        for (size_t v = graph_->layer_start[l]; v < graph_->layer_start[l+1]; v++)
+        {
+            int c = membership[v];
+
+            g.for_each_arc(v, omega, [&](int u, double w)
+            {
+                if (membership[u] == c)
+                {
+                    internal += w;
+                }
+            });
+
+            for (size_t p = g.strength_start[v]; p < g.strength_start[v+1]; p++)
+            {
+                if (K[c] == 0)
+                {
+                    touched[t].push_back(c);
+                }
+
+                K[c] += g.strength[p];
+            }
+        }
+
+        double expected = 0;
+
+        for (auto c: touched[t])
+        {
+            expected += K[c] * K[c];
+            K[c] = 0;
+        }
+
+        touched[t].clear();
+        partial[l] = internal - (layer_weight_[l] > 0 ? gamma * expected / layer_weight_[l] : 0);
+    }, 1);
+
+    double q = 0;
+
+    for (auto x: partial)
+    {
+        q += x;
+    }
+
+    double total = graph_->arc_weight + omega * graph_->num_couplings;
+    return total > 0 ? q / total : 0;
+}
+
+std::vector<double>
+GeneralizedLouvain::modularity_delta(
+    const std::vector<int>& membership,
+    const std::vector<int>& vertex,
+    const std::vector<int>& community,
+    double gamma,
+    double omega,
+    size_t num_threads
+) const
+{
+    const SupraGraph& g = graph_->g;
+    size_t n = g.num_vertices();
+    size_t L = layer_weight_.size();
+
+    check_partition(membership, n, "the partition");
+
+    if (vertex.size() != community.size())
+    {
+        throw uu::core::WrongParameterException("each move must have a vertex and a community");
+    }
+
+    for (size_t i = 0; i < vertex.size(); i++)
+    {
+        if (vertex[i] < 0 || (size_t)vertex[i] >= n || community[i] >= (int)n)
+        {
+            throw uu::core::WrongParameterException("moves must be to communities between 0 and the number of vertices - 1, or negative");
+        }
+    }
+
+    // strengths of the communities on each layer; each layer is filled by one task, in
+    // order, so the values do not depend on the number of threads
+    LayerTotals totals(L, g.strength.size());
+
+    parallel_for(L, num_threads, [&](size_t l, size_t)
+    {
+        for (size_t v = graph_->layer_start[l]; v < graph_->layer_start[l+1]; v++)
+        {
+            for (size_t p = g.strength_start[v]; p < g.strength_start[v+1]; p++)
+            {
+                totals.add(membership[v], g.strength_layer[p], g.strength[p]);
+            }
+        }
+    }, 1);
+
+    double total = graph_->arc_weight + omega * graph_->num_couplings;
+    std::vector<double> res(vertex.size(), 0);
+
+    parallel_for(vertex.size(), num_threads, [&](size_t i, size_t)
+    {
+        int v = vertex[i];
+        int from = membership[v];
+        int to = community[i];
+
+        if (to == from || total == 0)
+        {
+            return;
+        }
+
+        double weight_from = 0;
+        double weight_to = 0;
+
+        g.for_each_arc(v, omega, [&](int u, double w)
+        {
+            if (membership[u] == from)
+            {
+                weight_from += w;
+            }
+
+            else if (membership[u] == to)
+            {
+                weight_to += w;
+            }
+        });
+
+        // expected weight to the new community minus the one to the rest of the old
+        double expected = 0;
+
+        for (size_t p = g.strength_start[v]; p < g.strength_start[v+1]; p++)
+        {
+            int l = g.strength_layer[p];
+            double s = g.strength[p];
+            double total_to = to >= 0 ? totals.get(to, l) : 0;
+            double total_from = totals.get(from, l) - s;
+            expected += s * (total_to - total_from) / layer_weight_[l];
+        }
+
+        // arcs and couplings count in both directions
+        res[i] = 2 * (weight_to - weight_from - gamma * expected) / total;
+    }, 1024);
+
+    return res;
+}
+
+SupraPartition
+generalized_louvain(
+    const MLIndex& idx,
+    double gamma,
+    double omega,
+    Coupling coupling,
+    bool deterministic,
+    size_t num_threads
+)
+{
+    GeneralizedLouvain louvain(idx, coupling, num_threads);
+    return louvain.run(gamma, omega, deterministic, std::vector<int>(), num_threads);
+}
+
+SupraPartition
+louvain(
+    std::vector<size_t> start,
+    std::vector<int> nbr,
+    std::vector<double> weight,
+    double gamma,
+    bool deterministic,
+    size_t num_threads
+)
+{
+    GeneralizedLouvain louvain(std::move(start), std::move(nbr), std::move(weight));
+    return louvain.run(gamma, 0, deterministic, std::vector<int>(), num_threads);
+}
+
+std::vector<SupraPartition>
+generalized_louvain_sweep(
+    const MLIndex& idx,
+    const std::vector<double>& gammas,
+    const std::vector<double>& omegas,
+    Coupling coupling,
+    bool deterministic,
+    bool warm_start,
+    size_t num_threads
+)
+{
+    GeneralizedLouvain louvain(idx, coupling, num_threads);
+    size_t G = gammas.size();
+    size_t W = omegas.size();
+    std::vector<SupraPartition> res(G * W);
+
+    // with warm starts, the values of omega for each gamma form a chain of runs
+    size_t num_tasks = warm_start ? G : G * W;
+    size_t outer = std::max<size_t>(1, std::min(num_threads, num_tasks));
+    size_t inner = std::max<size_t>(1, num_threads / outer);
+
+    parallel_for(num_tasks, outer, [&](size_t task, size_t)
+    {
+        if (!warm_start)
+        {
+            res[task] = louvain.run(gammas[task / W], omegas[task % W], deterministic, std::vector<int>(), inner);
+            return;
+        }
+
+        const std::vector<int> none;
+
+        for (size_t j = 0; j < W; j++)
+        {
+            const auto& initial = j > 0 ? res[task * W + j - 1].membership : none;
+            res[task * W + j] = louvain.run(gammas[task], omegas[j], deterministic, initial, inner);
+        }
+    });
+
+    return res;
+}
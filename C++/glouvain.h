@@ -0,0 +1,200 @@
+#ifndef UU_R_MULTINET_GLOUVAIN_H_
+#define UU_R_MULTINET_GLOUVAIN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Partition of the vertices of a multilayer network, identified by their global
+ * position as in vertices_ml(). Communities are numbered from 0 in order of their
+ * first vertex.
+ */
+struct SupraPartition
+{
+    std::vector<int> membership;
+    size_t num_communities;
+
+    // generalized modularity of the partition
+    double modularity;
+};
+
+/**
+ * Couplings between the vertices of the same actor in the multilayer modularity.
+ */
+enum class Coupling
+{
+    // between all pairs of layers
+    CATEGORICAL,
+    // between consecutive layers, in the order of the layer store
+    ORDINAL
+};
+
+/**
+ * Generalized Louvain method (Mucha et al.) on the network indexed by idx, maximizing the
+ * multilayer modularity with resolution gamma and coupling omega between the vertices of
+ * each actor. Edges are considered undirected, self-loops are ignored, and edges are
+ * weighted by the attribute w_ if all layers have it.
+ *
+ * The supra-graph is stored in CSR format with the strength of each vertex; couplings
+ * are not stored but generated from the vertices of each actor, so memory grows with
+ * the number of edges and vertices and not with the number of coupled pairs.
+ *
+ * The local-moving phase processes the vertices in parallel. If deterministic is false,
+ * vertices are moved as soon as they are processed, updating the community weights
+ * atomically; with one thread this is the sequential algorithm. If deterministic is true,
+ * vertices are colored greedily, so that adjacent vertices have different colors, and
+ * the vertices of each color are processed together: their moves are chosen in parallel
+ * on the state before the color and then applied in order, so the result does not depend
+ * on the number of threads. Aggregation is parallel and
+ * deterministic in both cases.
+ *
+ * @throw WrongParameterException if a weight is not a non-negative number
+ */
+SupraPartition
+generalized_louvain(
+    const MLIndex& idx,
+    double gamma,
+    double omega,
+    Coupling coupling,
+    bool deterministic,
+    size_t num_threads
+);
+
+/**
+ * Louvain method on a weighted undirected graph, given in CSR format with each edge in
+ * both directions and without self-loops: generalized_louvain() with a single layer.
+ * Membership is indexed by vertex.
+ */
+SupraPartition
+louvain(
+    std::vector<size_t> start,
+    std::vector<int> nbr,
+    std::vector<double> weight,
+    double gamma,
+    bool deterministic,
+    size_t num_threads
+);
+
+/**
+ * Supra-graph of a network for generalized_louvain(), built once and shared by any
+ * number of (concurrent) runs with different parameters.
+ */
+class GeneralizedLouvain
+{
+  public:
+
+    /**
+     * @throw WrongParameterException if a weight is not a non-negative number
+     */
+    GeneralizedLouvain(
+        const MLIndex& idx,
+        Coupling coupling,
+        size_t num_threads
+    );
+
+    /**
+     * Supra-graph of a weighted undirected graph with a single layer, in the format
+     * of louvain().
+     */
+    GeneralizedLouvain(
+        std::vector<size_t> start,
+        std::vector<int> nbr,
+        std::vector<double> weight
+    );
+
+    ~GeneralizedLouvain(
+    );
+
+    size_t
+    num_vertices(
+    ) const;
+
+    /**
+     * Runs the algorithm, starting from the partition initial (one community identifier
+     * between 0 and num_vertices()-1 for each vertex) if not empty, or from singletons.
+     * @throw WrongParameterException if initial is not a valid partition
+     */
+    SupraPartition
+    run(
+        double gamma,
+        double omega,
+        bool deterministic,
+        const std::vector<int>& initial,
+        size_t num_threads
+    ) const;
+
+    /**
+     * Runs the algorithm from singletons on one thread, visiting the vertices of each
+     * level in a random order drawn from seed instead of in their order, so that runs with
+     * different seeds reach different local optima, e.g., to sample partitions for
+     * consensus clustering. Concurrent runs do not interfere.
+     */
+    SupraPartition
+    run_randomized(
+        double gamma,
+        double omega,
+        uint64_t seed
+    ) const;
+
+    /**
+     * Generalized modularity of a partition (one community identifier between 0 and
+     * num_vertices()-1 for each vertex), as maximized by run(). Each layer is processed by
+     * one task, summing the strengths of its communities, so that the result does not
+     * depend on the number of threads.
+     * @throw WrongParameterException if membership is not a valid partition
+     */
+    double
+    modularity(
+        const std::vector<int>& membership,
+        double gamma,
+        double omega,
+        size_t num_threads
+    ) const;
+
+    /**
+     * Change of the modularity of membership when only vertex[i] is moved to community[i]
+     * (a negative identifier is a new, empty community), for each i. The strengths of the
+     * communities on each layer are computed once for the whole batch; then each move is
+     * evaluated in parallel from the arcs of its vertex.
+     * @throw WrongParameterException if membership is not a valid partition or a move is
+     * not valid
+     */
+    std::vector<double>
+    modularity_delta(
+        const std::vector<int>& membership,
+        const std::vector<int>& vertex,
+        const std::vector<int>& community,
+        double gamma,
+        double omega,
+        size_t num_threads
+    ) const;
+
+  private:
+
+    struct Graph;
+    std::unique_ptr<Graph> graph_;
+    std::vector<double> layer_weight_;
+};
+
+/**
+ * Runs generalized_louvain() for each pair of values in gammas x omegas, building the
+ * supra-graph once and running the pairs in parallel. The result for gammas[i] and
+ * omegas[j] is at position i * omegas.size() + j. If warm_start is true, the runs for
+ * each gamma are chained: the run for omegas[j] starts from the partition found for
+ * omegas[j-1], and the chains of different gammas run in parallel.
+ */
+std::vector<SupraPartition>
+generalized_louvain_sweep(
+    const MLIndex& idx,
+    const std::vector<double>& gammas,
+    const std::vector<double>& omegas,
+    Coupling coupling,
+    bool deterministic,
+    bool warm_start,
+    size_t num_threads
+);
+
+#endif
@@ -0,0 +1,331 @@
+#include "label_propagation.h"
+#include "cores.h"
+#include "parallel.h"
+#include "core/exceptions/WrongParameterException.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+
+const size_t kMaxRounds = 100;
+
+// finalizer of splitmix64
+uint64_t
+mix64(
+    uint64_t x
+)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// neighbors of each actor on all the layers, one arc for each layer, weighted by the
+// relevance of the layer for the actor
+struct ActorGraph
+{
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+    std::vector<double> weight;
+};
+
+ActorGraph
+actor_graph(
+    const MLIndex& idx,
+    size_t num_threads
+)
+{
+    size_t n = idx.num_actors();
+    size_t L = idx.num_layers();
+
+    std::vector<size_t> all(L);
+
+    for (size_t l = 0; l < L; l++)
+    {
+        all[l] = l;
+    }
+
+    auto g = core_graph(idx, all, num_threads);
+
+    ActorGraph res;
+    res.start.assign(n + 1, 0);
+
+    for (size_t a = 0; a < n; a++)
+    {
+        size_t degree = 0;
+
+        for (size_t l = 0; l < L; l++)
+        {
+            degree += g.start[l][a+1] - g.start[l][a];
+        }
+
+        res.start[a+1] = res.start[a] + degree;
+    }
+
+    res.nbr.resize(res.start[n]);
+    res.weight.resize(res.start[n]);
+
+    parallel_for(n, num_threads, [&](size_t a, size_t)
+    {
+        size_t q = res.start[a];
+        double degree = res.start[a+1] - res.start[a];
+
+        for (size_t l = 0; l < L; l++)
+        {
+            size_t begin = g.start[l][a];
+            size_t end = g.start[l][a+1];
+            double relevance = (end - begin) / degree;
+
+            for (size_t p = begin; p < end; p++)
+            {
+                res.nbr[q] = g.nbr[l][p];
+                res.weight[q] = relevance;
+                q++;
+            }
+        }
+    }, 1024);
+
+    return res;
+}
+
+// label with the highest score among the neighbors of an actor
+class Scores
+{
+  public:
+
+    explicit
+    Scores(
+        size_t n
+    ) : score_(n, 0)
+    {
+    }
+
+    int
+    best(
+        const ActorGraph& g,
+        const std::atomic<int>* label,
+        int a
+    )
+    {
+        for (size_t p = g.start[a]; p < g.start[a+1]; p++)
+        {
+            int c = label[g.nbr[p]].load(std::memory_order_relaxed);
+
+            if (score_[c] == 0)
+            {
+                touched_.push_back(c);
+            }
+
+            score_[c] += g.weight[p];
+        }
+
+        double best_score = 0;
+
+        for (auto c: touched_)
+        {
+            best_score = std::max(best_score, score_[c]);
+        }
+
+        // the current label is kept if it is among the best ones
+        int res = label[a].load(std::memory_order_relaxed);
+
+        if (score_[res] < best_score)
+        {
+            res = (int)score_.size();
+
+            for (auto c: touched_)
+            {
+                if (score_[c] == best_score && c < res)
+                {
+                    res = c;
+                }
+            }
+        }
+
+        for (auto c: touched_)
+        {
+            score_[c] = 0;
+        }
+
+        touched_.clear();
+        return res;
+    }
+
+  private:
+
+    std::vector<double> score_;
+    std::vector<int> touched_;
+};
+
+}
+
+ActorPartition
+label_propagation(
+    const MLIndex& idx,
+    const std::vector<int>& initial,
+    bool deterministic,
+    uint64_t seed,
+    size_t num_threads
+)
+{
+    size_t n = idx.num_actors();
+
+    if (!initial.empty() && initial.size() != n)
+    {
+        throw uu::core::WrongParameterException("the initial labels must contain all the actors");
+    }
+
+    std::unique_ptr<std::atomic<int>[]> label(new std::atomic<int>[n]);
+    std::unique_ptr<std::atomic<char>[]> queued(new std::atomic<char>[n]);
+
+    for (size_t a = 0; a < n; a++)
+    {
+        int c = initial.empty() ? a : initial[a];
+
+        if (c < 0 || (size_t)c >= n)
+        {
+            throw uu::core::WrongParameterException("labels must be between 0 and the number of actors - 1");
+        }
+
+        label[a].store(c, std::memory_order_relaxed);
+        queued[a].store(0, std::memory_order_relaxed);
+    }
+
+    auto g = actor_graph(idx, num_threads);
+
+    // actors to process in the current round: initially those with neighbors, then
+    // those with a neighbor that changed label in the previous round
+    std::vector<int> frontier;
+
+    for (size_t a = 0; a < n; a++)
+    {
+        if (g.start[a+1] > g.start[a])
+        {
+            frontier.push_back(a);
+        }
+    }
+
+    std::vector<std::unique_ptr<Scores>> workspaces(num_threads);
+    std::vector<std::vector<int>> next(num_threads);
+    std::vector<int> decision;
+
+    auto workspace = [&](size_t t) -> Scores&
+    {
+        if (!workspaces[t])
+        {
+            workspaces[t].reset(new Scores(n));
+        }
+
+        return *workspaces[t];
+    };
+
+    auto enqueue = [&](int a, size_t t)
+    {
+        char expected = 0;
+
+        if (queued[a].compare_exchange_strong(expected, 1, std::memory_order_relaxed))
+        {
+            next[t].push_back(a);
+        }
+    };
+
+    auto changed = [&](int a, int c, size_t t)
+    {
+        label[a].store(c, std::memory_order_relaxed);
+
+        for (size_t p = g.start[a]; p < g.start[a+1]; p++)
+        {
+            enqueue(g.nbr[p], t);
+        }
+    };
+
+    for (size_t round = 0; round < kMaxRounds && !frontier.empty(); round++)
+    {
+        if (deterministic)
+        {
+            // decisions on the labels at the start of the round; each change is applied
+            // with probability 1/2, drawn from the seed, so that neighbors do not keep
+            // swapping their labels
+            decision.resize(frontier.size());
+
+            parallel_for(frontier.size(), num_threads, [&](size_t i, size_t t)
+            {
+                decision[i] = workspace(t).best(g, label.get(), frontier[i]);
+            }, 256);
+
+            parallel_for(frontier.size(), num_threads, [&](size_t i, size_t t)
+            {
+                int a = frontier[i];
+
+                if (decision[i] == label[a].load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                if (mix64(seed ^ mix64(round * n + a)) & 1)
+                {
+                    changed(a, decision[i], t);
+                }
+
+                else
+                {
+                    enqueue(a, t);
+                }
+            }, 256);
+        }
+
+        else
+        {
+            // labels are updated as soon as they are decided
+            parallel_for(frontier.size(), num_threads, [&](size_t i, size_t t)
+            {
+                int a = frontier[i];
+                int c = workspace(t).best(g, label.get(), a);
+
+                if (c != label[a].load(std::memory_order_relaxed))
+                {
+                    changed(a, c, t);
+                }
+            }, 256);
+        }
+
+        frontier.clear();
+
+        for (auto& list: next)
+        {
+            frontier.insert(frontier.end(), list.begin(), list.end());
+            list.clear();
+        }
+
+        std::sort(frontier.begin(), frontier.end());
+
+        for (auto a: frontier)
+        {
+            queued[a].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // numbering by first actor
+    ActorPartition res;
+    res.membership.resize(n);
+    res.num_communities = 0;
+    std::vector<int> id(n, -1);
+
+    for (size_t a = 0; a < n; a++)
+    {
+        int& c = id[label[a].load(std::memory_order_relaxed)];
+
+        if (c < 0)
+        {
+            c = res.num_communities++;
+        }
+
+        res.membership[a] = c;
+    }
+
+    return res;
+}
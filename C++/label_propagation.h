@@ -0,0 +1,50 @@
+#ifndef UU_R_MULTINET_LABEL_PROPAGATION_H_
+#define UU_R_MULTINET_LABEL_PROPAGATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Partition of the actors of a multilayer network (positions in idx.actors), with
+ * communities numbered from 0 in order of their first actor.
+ */
+struct ActorPartition
+{
+    std::vector<int> membership;
+    size_t num_communities;
+};
+
+/**
+ * Multidimensional label propagation. Each actor repeatedly adopts the label with the
+ * highest score among its neighbors, where a neighbor on layer l contributes the
+ * relevance of l for the actor (the fraction of the actor's edges that are on l), keeping
+ * its label in case of ties and otherwise preferring the smallest label. Edges are
+ * considered undirected and self-loops are ignored.
+ *
+ * Labels are propagated in rounds (at most 100), each processing in parallel the actors
+ * with a neighbor whose label changed in the previous round, so that the regions that
+ * have converged are skipped; the first round processes all the actors with neighbors.
+ * If deterministic is false, labels are stored as soon as they are decided, and other
+ * threads may or may not see them in the same round; with one thread, actors are
+ * processed in order. If deterministic is true, the new labels are decided on the labels
+ * at the start of the round, and each change is applied or postponed to the next round
+ * with probability 1/2 drawn from seed, so that the result only depends on seed and not
+ * on the number of threads.
+ *
+ * Each actor a starts with label initial[a] (between 0 and the number of actors - 1) if
+ * initial is not empty, or with a label of its own.
+ *
+ * @throw WrongParameterException if initial is not a valid labelling
+ */
+ActorPartition
+label_propagation(
+    const MLIndex& idx,
+    const std::vector<int>& initial,
+    bool deterministic,
+    uint64_t seed,
+    size_t num_threads
+);
+
+#endif
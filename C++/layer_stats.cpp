@@ -0,0 +1,537 @@
+#include "layer_stats.h"
+#include "components.h"
+#include "triangles.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+
+namespace {
+
+// breadth-first search on the out (or in) lists, reusing its memory between runs
+class BFS
+{
+  public:
+
+    explicit
+    BFS(
+        size_t n
+    ) : dist_(n, -1)
+    {
+    }
+
+    // visits the vertices reachable from s (that reach s, if reverse); queue() lists them
+    // by distance
+    void
+    run(
+        const LayerIndex& g,
+        int s,
+        bool reverse = false
+    )
+    {
+        for (auto v: queue_)
+        {
+            dist_[v] = -1;
+        }
+
+        queue_.clear();
+        queue_.push_back(s);
+        dist_[s] = 0;
+
+        for (size_t h = 0; h < queue_.size(); h++)
+        {
+            int v = queue_[h];
+            auto first = reverse ? g.in_begin(v) : g.out_begin(v);
+            auto last = reverse ? g.in_end(v) : g.out_end(v);
+
+            for (auto p = first; p != last; ++p)
+            {
+                if (dist_[*p] < 0)
+                {
+                    dist_[*p] = dist_[v] + 1;
+                    queue_.push_back(*p);
+                }
+            }
+        }
+    }
+
+    const std::vector<int>&
+    queue(
+    ) const
+    {
+        return queue_;
+    }
+
+    int
+    dist(
+        int v
+    ) const
+    {
+        return dist_[v];
+    }
+
+    // eccentricity of the last source
+    size_t
+    eccentricity(
+    ) const
+    {
+        return dist_[queue_.back()];
+    }
+
+  private:
+
+    std::vector<int> dist_;
+    std::vector<int> queue_;
+};
+
+// diameter of the component of an undirected graph containing u (iFUB, Crescenzi et al.)
+size_t
+ifub(
+    const LayerIndex& g,
+    int u,
+    BFS& bfs
+)
+{
+    bfs.run(g, u);
+    size_t lb = bfs.eccentricity();
+
+    // fringe: vertices at each distance from u
+    std::vector<int> order = bfs.queue();
+    std::vector<size_t> level_start(lb + 2, 0);
+
+    for (auto v: order)
+    {
+        level_start[bfs.dist(v) + 1]++;
+    }
+
+    for (size_t i = 0; i <= lb; i++)
+    {
+        level_start[i+1] += level_start[i];
+    }
+
+    // vertices at distance less than i from u have eccentricity at most 2(i-1)
+    // or reach a vertex at distance at least i from u
+    for (size_t i = lb; i > 0 && 2 * i > lb; i--)
+    {
+        for (size_t p = level_start[i]; p < level_start[i+1]; p++)
+        {
+            bfs.run(g, order[p]);
+            lb = std::max(lb, bfs.eccentricity());
+        }
+
+        if (lb >= 2 * (i - 1))
+        {
+            break;
+        }
+    }
+
+    return lb;
+}
+
+bool
+has_edges(
+    const LayerIndex& g,
+    size_t v
+)
+{
+    return g.out_degree(v) > 0 || g.in_degree(v) > 0;
+}
+
+}
+
+LayerIndex
+flat_layer_index(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    bool directed
+)
+{
+    LayerIndex res;
+    res.layer = nullptr;
+    res.directed = directed;
+    res.offset = 0;
+    res.num_loops = 0;
+
+    std::vector<int> vertex(idx.num_actors(), -1);
+
+    for (auto l: layers)
+    {
+        for (auto a: idx.layers[l].actor)
+        {
+            vertex[a] = 0;
+        }
+    }
+
+    for (size_t a = 0; a < idx.num_actors(); a++)
+    {
+        if (vertex[a] == 0)
+        {
+            vertex[a] = res.actor.size();
+            res.actor.push_back(a);
+        }
+    }
+
+    size_t n = res.actor.size();
+    res.loop.assign(n, 0);
+    auto g = flat_graph(idx, layers);
+
+    // arcs between vertices, in both directions if directionality is ignored
+
+    res.out_start.assign(n + 1, 0);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        int a = res.actor[v];
+
+        for (size_t p = g.start[a]; p < g.start[a+1]; p++)
+        {
+            res.out_start[v + 1]++;
+
+            if (!directed)
+            {
+                res.out_start[vertex[g.target[p]] + 1]++;
+            }
+        }
+    }
+
+    for (size_t v = 0; v < n; v++)
+    {
+        res.out_start[v+1] += res.out_start[v];
+    }
+
+    std::vector<size_t> pos(res.out_start.begin(), res.out_start.end() - 1);
+    res.out_nbr.resize(res.out_start[n]);
+
+    for (size_t v = 0; v < n; v++)
+    {
+        int a = res.actor[v];
+
+        for (size_t p = g.start[a]; p < g.start[a+1]; p++)
+        {
+            int u = vertex[g.target[p]];
+            res.out_nbr[pos[v]++] = u;
+
+            if (!directed)
+            {
+                res.out_nbr[pos[u]++] = v;
+            }
+        }
+    }
+
+    // sorted lists without duplicates and self-loops
+
+    size_t q = 0;
+
+    for (size_t v = 0; v < n; v++)
+    {
+        auto begin = res.out_nbr.begin() + res.out_start[v];
+        auto end = res.out_nbr.begin() + res.out_start[v+1];
+        std::sort(begin, end);
+        res.out_start[v] = q;
+        int last = -1;
+
+        for (auto p = begin; p != end; ++p)
+        {
+            if (*p != last && *p != (int)v)
+            {
+                res.out_nbr[q++] = *p;
+            }
+
+            last = *p;
+        }
+    }
+
+    res.out_start[n] = q;
+    res.out_nbr.resize(q);
+    res.num_edges = directed ? q : q / 2;
+
+    if (directed)
+    {
+        res.in_start.assign(n + 1, 0);
+
+        for (auto u: res.out_nbr)
+        {
+            res.in_start[u + 1]++;
+        }
+
+        for (size_t v = 0; v < n; v++)
+        {
+            res.in_start[v+1] += res.in_start[v];
+        }
+
+        std::vector<size_t> in_pos(res.in_start.begin(), res.in_start.end() - 1);
+        res.in_nbr.resize(q);
+
+        // sources are visited in order, so the in lists are sorted
+        for (size_t v = 0; v < n; v++)
+        {
+            for (auto p = res.out_begin(v); p != res.out_end(v); ++p)
+            {
+                res.in_nbr[in_pos[*p]++] = v;
+            }
+        }
+    }
+
+    return res;
+}
+
+std::vector<GraphSummary>
+summarize_graphs(
+    const std::vector<const LayerIndex*>& graphs,
+    const std::vector<bool>& isolated,
+    size_t samples,
+    double delta,
+    uint64_t seed,
+    size_t num_threads
+)
+{
+    size_t G = graphs.size();
+    std::vector<GraphSummary> res(G);
+    std::vector<Components> comps(G);
+
+    // components and triangles, one graph per thread
+
+    parallel_for(G, num_threads, [&](size_t i, size_t)
+    {
+        auto& g = *graphs[i];
+        auto& s = res[i];
+        comps[i] = layer_components(g, true, 1);
+
+        // components containing at least one vertex with edges
+        std::vector<char> counted(comps[i].num_components(), isolated[i]);
+        s.n = isolated[i] ? g.num_vertices() : 0;
+
+        for (size_t v = 0; v < g.num_vertices(); v++)
+        {
+            if (has_edges(g, v))
+            {
+                counted[comps[i].membership[v]] = 1;
+                s.n += !isolated[i];
+            }
+        }
+
+        s.nc = 0;
+        s.slc = 0;
+
+        for (size_t c = 0; c < counted.size(); c++)
+        {
+            if (counted[c])
+            {
+                s.nc++;
+                s.slc = std::max(s.slc, comps[i].size[c]);
+            }
+        }
+
+        s.cc = transitivity(find_triangles(g, 1, false));
+    });
+
+    // breadth-first searches of all graphs
+
+    std::vector<std::pair<int, int>> tasks;
+    std::vector<bool> sampled(G);
+    std::vector<size_t> num_present(G);
+    size_t max_n = 0;
+
+    for (size_t i = 0; i < G; i++)
+    {
+        auto& g = *graphs[i];
+        max_n = std::max(max_n, g.num_vertices());
+
+        std::vector<int> present;
+
+        for (size_t v = 0; v < g.num_vertices(); v++)
+        {
+            if (has_edges(g, v))
+            {
+                present.push_back(v);
+            }
+        }
+
+        num_present[i] = present.size();
+        sampled[i] = samples > 0 && samples < present.size();
+
+        if (!sampled[i])
+        {
+            for (auto v: present)
+            {
+                tasks.push_back(std::make_pair(i, v));
+            }
+
+            continue;
+        }
+
+        std::mt19937_64 rng(seed + i);
+
+        for (size_t k = 0; k < samples; k++)
+        {
+            tasks.push_back(std::make_pair(i, present[rng() % present.size()]));
+        }
+    }
+
+    std::vector<uint64_t> sum(tasks.size());
+    std::vector<uint64_t> reached(tasks.size());
+    std::vector<size_t> ecc(tasks.size());
+    std::vector<std::unique_ptr<BFS>> workspaces(num_threads);
+
+    parallel_for(tasks.size(), num_threads, [&](size_t task, size_t t)
+    {
+        if (!workspaces[t])
+        {
+            workspaces[t].reset(new BFS(max_n));
+        }
+
+        auto& bfs = *workspaces[t];
+        bfs.run(*graphs[tasks[task].first], tasks[task].second);
+
+        for (auto v: bfs.queue())
+        {
+            sum[task] += bfs.dist(v);
+        }
+
+        reached[task] = bfs.queue().size() - 1;
+        ecc[task] = bfs.eccentricity();
+    }, 16);
+
+    std::vector<uint64_t> total_sum(G, 0);
+    std::vector<uint64_t> total_reached(G, 0);
+
+    // true if all the sources reach all the other vertices with edges
+    std::vector<bool> connected(G, true);
+
+    for (auto& s: res)
+    {
+        s.dia = 0;
+        s.dia_exact = true;
+        s.apl_error = 0;
+    }
+
+    for (size_t task = 0; task < tasks.size(); task++)
+    {
+        size_t i = tasks[task].first;
+        total_sum[i] += sum[task];
+        total_reached[i] += reached[task];
+        connected[i] = connected[i] && reached[task] + 1 == num_present[i];
+        res[i].dia = std::max(res[i].dia, ecc[task]);
+    }
+
+    for (size_t i = 0; i < G; i++)
+    {
+        auto& s = res[i];
+        s.apl = total_reached[i] > 0 ? (double)total_sum[i] / total_reached[i] : std::numeric_limits<double>::quiet_NaN();
+
+        s.dia_exact = !sampled[i];
+    }
+
+    // exact diameter of the sampled undirected graphs: iFUB from the vertex with
+    // highest degree of each component
+
+    std::vector<std::pair<int, int>> starts;
+
+    for (size_t i = 0; i < G; i++)
+    {
+        auto& g = *graphs[i];
+
+        if (!sampled[i] || g.directed)
+        {
+            continue;
+        }
+
+        std::vector<int> best(comps[i].num_components(), -1);
+
+        for (size_t v = 0; v < g.num_vertices(); v++)
+        {
+            int& b = best[comps[i].membership[v]];
+
+            if (g.out_degree(v) > 0 && (b < 0 || g.out_degree(v) > g.out_degree(b)))
+            {
+                b = v;
+            }
+        }
+
+        for (auto b: best)
+        {
+            if (b >= 0)
+            {
+                starts.push_back(std::make_pair(i, b));
+            }
+        }
+
+        res[i].dia = 0;
+        res[i].dia_exact = true;
+    }
+
+    std::vector<size_t> diameter(starts.size());
+
+    parallel_for(starts.size(), num_threads, [&](size_t task, size_t t)
+    {
+        if (!workspaces[t])
+        {
+            workspaces[t].reset(new BFS(max_n));
+        }
+
+        diameter[task] = ifub(*graphs[starts[task].first], starts[task].second, *workspaces[t]);
+    });
+
+    for (size_t task = 0; task < starts.size(); task++)
+    {
+        auto& s = res[starts[task].first];
+        s.dia = std::max(s.dia, diameter[task]);
+    }
+
+    // the average distance from a source is between 1 and the diameter; if all the
+    // sources reach the same vertices, apl is the mean of these averages over the sampled
+    // sources, and Hoeffding's bound holds. Otherwise apl is a ratio of sums, weighting
+    // each source by the vertices it reaches, and no bound is returned.
+    // The diameter of sampled directed graphs is only known from below: for these, the
+    // range is bounded by ecc_out(s) + ecc_in(s), for the sampled source s with the
+    // smallest eccentricity, as every path can be routed through s
+    std::vector<int> center(G, -1);
+
+    for (size_t task = 0; task < tasks.size(); task++)
+    {
+        size_t i = tasks[task].first;
+
+        if (sampled[i] && graphs[i]->directed && connected[i] && (center[i] < 0 || ecc[task] < ecc[center[i]]))
+        {
+            center[i] = task;
+        }
+    }
+
+    std::vector<size_t> range(G);
+    std::vector<size_t> reverse;
+
+    for (size_t i = 0; i < G; i++)
+    {
+        range[i] = res[i].dia;
+
+        if (center[i] >= 0)
+        {
+            reverse.push_back(i);
+        }
+    }
+
+    parallel_for(reverse.size(), num_threads, [&](size_t task, size_t t)
+    {
+        if (!workspaces[t])
+        {
+            workspaces[t].reset(new BFS(max_n));
+        }
+
+        size_t i = reverse[task];
+        workspaces[t]->run(*graphs[i], tasks[center[i]].second, true);
+        range[i] = ecc[center[i]] + workspaces[t]->eccentricity();
+    });
+
+    for (size_t i = 0; i < G; i++)
+    {
+        if (sampled[i])
+        {
+            res[i].apl_error = connected[i] ? range[i] * std::sqrt(std::log(2 / delta) / (2.0 * samples)) :
+                               std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    return res;
+}
@@ -0,0 +1,71 @@
+#ifndef UU_R_MULTINET_LAYER_STATS_H_
+#define UU_R_MULTINET_LAYER_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Basic statistics of a graph, as reported by summary(). Self-loops are ignored.
+ */
+struct GraphSummary
+{
+    // number of vertices (only those with edges, if isolated vertices are excluded)
+    size_t n;
+
+    // number and size of the largest of the (strongly, for directed graphs) connected components
+    size_t nc;
+    size_t slc;
+
+    // global transitivity, ignoring edge directionality (NaN without connected triples)
+    double cc;
+
+    // average length of the shortest paths between connected pairs (NaN if there are none),
+    // and half-width of its confidence interval if estimated (0 if exact, NaN if the graph
+    // is not (strongly) connected, where the bound does not hold)
+    double apl;
+    double apl_error;
+
+    // longest shortest path; a lower bound if not exact
+    size_t dia;
+    bool dia_exact;
+};
+
+/**
+ * Builds the flattened graph of the input layers (indices in idx.layers) as a
+ * LayerIndex: one vertex for each actor present in at least one of the layers, and an
+ * edge between two actors if they are adjacent on one of the layers or through an
+ * interlayer edge between them (idx must include the interlayer edges). If directed is
+ * false, edge directionality is ignored.
+ */
+LayerIndex
+flat_layer_index(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    bool directed
+);
+
+/**
+ * Computes the statistics of the input graphs.
+ *
+ * Components and triangles are computed in parallel across graphs. Distances are
+ * computed by breadth-first searches from all the vertices, or from samples vertices
+ * drawn uniformly (with replacement, using seed) for each graph with more vertices; in
+ * this case, the error of the average path length is a Hoeffding bound with probability
+ * 1-delta, and the diameter of undirected graphs is still computed exactly using the
+ * iFUB algorithm on each component. For directed graphs, the bound uses the sum of the
+ * out- and in-eccentricity of a sampled vertex, an upper bound of the diameter. The searches of all graphs are processed in parallel,
+ * and the results do not depend on the number of threads.
+ */
+std::vector<GraphSummary>
+summarize_graphs(
+    const std::vector<const LayerIndex*>& graphs,
+    const std::vector<bool>& isolated,
+    size_t samples,
+    double delta,
+    uint64_t seed,
+    size_t num_threads
+);
+
+#endif
@@ -0,0 +1,382 @@
+#include "live_stats.h"
+#include "measures/neighborhood.hpp"
+
+LiveStats::
+LiveStats(
+    const uu::net::MultilayerNetwork* mnet,
+    bool track_neighbors
+) : track_neighbors_(track_neighbors), invalid_(true), num_slots_(0)
+{
+    rebuild(mnet);
+}
+
+void
+LiveStats::
+rebuild(
+    const uu::net::MultilayerNetwork* mnet
+)
+{
+    actor_pos_.clear();
+    num_slots_ = 0;
+    layers_.clear();
+    in_neighbors_.clear();
+    out_neighbors_.clear();
+    all_neighbors_.clear();
+
+    actor_pos_.reserve(mnet->actors()->size());
+
+    for (auto actor: *mnet->actors())
+    {
+        slot(actor);
+    }
+
+    for (auto layer: *mnet->layers())
+    {
+        layer_stats(layer);
+
+        for (auto edge: *layer->edges())
+        {
+            update(layer, edge->v1, edge->v2, 1);
+        }
+    }
+
+    invalid_ = false;
+}
+
+void
+LiveStats::
+invalidate(
+)
+{
+    invalid_ = true;
+}
+
+bool
+LiveStats::
+valid(
+    const uu::net::MultilayerNetwork* mnet
+) const
+{
+    if (invalid_ || layers_.size() != mnet->layers()->size())
+    {
+        return false;
+    }
+
+    for (auto layer: *mnet->layers())
+    {
+        auto l = layers_.find(layer);
+
+        if (l == layers_.end() || l->second.num_edges != layer->edges()->size())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+LiveStats::
+tracks_neighbors(
+) const
+{
+    return track_neighbors_;
+}
+
+void
+LiveStats::
+add_edge(
+    const uu::net::Network* layer,
+    const uu::net::Vertex* v1,
+    const uu::net::Vertex* v2
+)
+{
+    update(layer, v1, v2, 1);
+}
+
+void
+LiveStats::
+erase_edge(
+    const uu::net::Network* layer,
+    const uu::net::Vertex* v1,
+    const uu::net::Vertex* v2
+)
+{
+    update(layer, v1, v2, -1);
+}
+
+void
+LiveStats::
+erase_vertex(
+    uu::net::Network* layer,
+    const uu::net::Vertex* actor
+)
+{
+    if (!layer->vertices()->contains(actor))
+    {
+        return;
+    }
+
+    std::vector<uu::net::Network*> l = {layer};
+
+    // on undirected layers, out-neighbors are all the neighbors
+    for (auto neighbor: uu::net::neighbors(l.begin(), l.end(), actor, uu::net::EdgeMode::OUT))
+    {
+        update(layer, actor, neighbor, -1);
+    }
+
+    if (layer->is_directed())
+    {
+        for (auto neighbor: uu::net::neighbors(l.begin(), l.end(), actor, uu::net::EdgeMode::IN))
+        {
+            // loops have already been removed as outgoing edges
+            if (neighbor != actor)
+            {
+                update(layer, neighbor, actor, -1);
+            }
+        }
+    }
+}
+
+void
+LiveStats::
+erase_actor(
+    uu::net::MultilayerNetwork* mnet,
+    const uu::net::Vertex* actor
+)
+{
+    for (auto layer: *mnet->layers())
+    {
+        erase_vertex(layer, actor);
+    }
+
+    auto a = actor_pos_.find(actor);
+
+    if (a == actor_pos_.end())
+    {
+        return;
+    }
+
+    // the position is not reused: its counts are now 0
+    if (track_neighbors_)
+    {
+        NeighborCounts().swap(in_neighbors_[a->second]);
+        NeighborCounts().swap(out_neighbors_[a->second]);
+        NeighborCounts().swap(all_neighbors_[a->second]);
+    }
+
+    actor_pos_.erase(a);
+}
+
+long
+LiveStats::
+degree(
+    const uu::net::Network* layer,
+    const uu::net::Vertex* actor,
+    const uu::net::EdgeMode& mode
+) const
+{
+    auto l = layers_.find(layer);
+    auto a = actor_pos_.find(actor);
+
+    if (l == layers_.end() || a == actor_pos_.end())
+    {
+        return 0;
+    }
+
+    auto& stats = l->second;
+
+    if (!stats.directed)
+    {
+        return stats.out[a->second];
+    }
+
+    switch (mode)
+    {
+    case uu::net::EdgeMode::IN:
+        return stats.in[a->second];
+
+    case uu::net::EdgeMode::OUT:
+        return stats.out[a->second];
+
+    default:
+        // a loop is a single edge, as in degree()
+        return stats.in[a->second] + stats.out[a->second] - stats.loops[a->second];
+    }
+}
+
+long
+LiveStats::
+neighborhood(
+    const uu::net::Vertex* actor,
+    const uu::net::EdgeMode& mode
+) const
+{
+    auto a = actor_pos_.find(actor);
+
+    if (!track_neighbors_ || a == actor_pos_.end())
+    {
+        return 0;
+    }
+
+    switch (mode)
+    {
+    case uu::net::EdgeMode::IN:
+        return in_neighbors_[a->second].size();
+
+    case uu::net::EdgeMode::OUT:
+        return out_neighbors_[a->second].size();
+
+    default:
+        return all_neighbors_[a->second].size();
+    }
+}
+
+size_t
+LiveStats::
+slot(
+    const uu::net::Vertex* actor
+)
+{
+    auto a = actor_pos_.find(actor);
+
+    if (a != actor_pos_.end())
+    {
+        return a->second;
+    }
+
+    size_t pos = num_slots_++;
+    actor_pos_[actor] = pos;
+
+    for (auto& l: layers_)
+    {
+        l.second.out.resize(num_slots_, 0);
+
+        if (l.second.directed)
+        {
+            l.second.in.resize(num_slots_, 0);
+            l.second.loops.resize(num_slots_, 0);
+        }
+    }
+
+    if (track_neighbors_)
+    {
+        in_neighbors_.resize(num_slots_);
+        out_neighbors_.resize(num_slots_);
+        all_neighbors_.resize(num_slots_);
+    }
+
+    return pos;
+}
+
+LiveStats::LayerStats&
+LiveStats::
+layer_stats(
+    const uu::net::Network* layer
+)
+{
+    auto l = layers_.find(layer);
+
+    if (l != layers_.end())
+    {
+        return l->second;
+    }
+
+    LayerStats& stats = layers_[layer];
+    stats.directed = layer->is_directed();
+    stats.num_edges = 0;
+    stats.out.assign(num_slots_, 0);
+
+    if (stats.directed)
+    {
+        stats.in.assign(num_slots_, 0);
+        stats.loops.assign(num_slots_, 0);
+    }
+
+    return stats;
+}
+
+void
+LiveStats::
+update(
+    const uu::net::Network* layer,
+    const uu::net::Vertex* v1,
+    const uu::net::Vertex* v2,
+    long delta
+)
+{
+    size_t a1 = slot(v1);
+    size_t a2 = slot(v2);
+
+    // references to the elements of an unordered_map survive insertions
+    LayerStats& stats = layer_stats(layer);
+    stats.num_edges += delta;
+
+    if (stats.directed)
+    {
+        stats.out[a1] += delta;
+        stats.in[a2] += delta;
+
+        if (a1 == a2)
+        {
+            stats.loops[a1] += delta;
+        }
+    }
+
+    else
+    {
+        stats.out[a1] += delta;
+
+        if (a1 != a2)
+        {
+            stats.out[a2] += delta;
+        }
+    }
+
+    if (!track_neighbors_)
+    {
+        return;
+    }
+
+    count(out_neighbors_[a1], v2, delta);
+    count(all_neighbors_[a1], v2, delta);
+
+    if (stats.directed)
+    {
+        count(in_neighbors_[a2], v1, delta);
+
+        if (a1 != a2)
+        {
+            count(all_neighbors_[a2], v1, delta);
+        }
+    }
+
+    else
+    {
+        count(in_neighbors_[a1], v2, delta);
+
+        if (a1 != a2)
+        {
+            count(out_neighbors_[a2], v1, delta);
+            count(in_neighbors_[a2], v1, delta);
+            count(all_neighbors_[a2], v1, delta);
+        }
+    }
+}
+
+void
+LiveStats::
+count(
+    NeighborCounts& counts,
+    const uu::net::Vertex* neighbor,
+    long delta
+)
+{
+    long& c = counts[neighbor];
+    c += delta;
+
+    if (c <= 0)
+    {
+        counts.erase(neighbor);
+    }
+}
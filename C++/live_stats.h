@@ -0,0 +1,152 @@
+#ifndef UU_R_MULTINET_LIVE_STATS_H_
+#define UU_R_MULTINET_LIVE_STATS_H_
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "networks/MultilayerNetwork.hpp"
+
+/**
+ * Degree (and optionally neighborhood) statistics of the actors of a multilayer network,
+ * kept up to date while edges, vertices and actors are added and removed, so that
+ * degree and neighborhood queries do not need to scan the network.
+ *
+ * Only intralayer edges are considered. Modifications not notified to the object are
+ * detected by valid() when they change the set of layers or their number of edges;
+ * in this case the statistics must be rebuilt.
+ */
+class LiveStats
+{
+  public:
+
+    LiveStats(
+        const uu::net::MultilayerNetwork* mnet,
+        bool track_neighbors
+    );
+
+    /** Recomputes all the statistics from scratch. */
+    void
+    rebuild(
+        const uu::net::MultilayerNetwork* mnet
+    );
+
+    /** Forces a rebuild at the next check. */
+    void
+    invalidate(
+    );
+
+    /** Checks whether the statistics are consistent with mnet. */
+    bool
+    valid(
+        const uu::net::MultilayerNetwork* mnet
+    ) const;
+
+    bool
+    tracks_neighbors(
+    ) const;
+
+    /** To be called after the edge (v1,v2) has been added to layer. */
+    void
+    add_edge(
+        const uu::net::Network* layer,
+        const uu::net::Vertex* v1,
+        const uu::net::Vertex* v2
+    );
+
+    /** To be called before or after the edge (v1,v2) is removed from layer. */
+    void
+    erase_edge(
+        const uu::net::Network* layer,
+        const uu::net::Vertex* v1,
+        const uu::net::Vertex* v2
+    );
+
+    /** To be called before actor is removed from layer, together with its edges. */
+    void
+    erase_vertex(
+        uu::net::Network* layer,
+        const uu::net::Vertex* actor
+    );
+
+    /** To be called before actor is removed from the network. */
+    void
+    erase_actor(
+        uu::net::MultilayerNetwork* mnet,
+        const uu::net::Vertex* actor
+    );
+
+    /** Degree of actor on layer (0 if the actor or the layer are unknown). */
+    long
+    degree(
+        const uu::net::Network* layer,
+        const uu::net::Vertex* actor,
+        const uu::net::EdgeMode& mode
+    ) const;
+
+    /**
+     * Number of distinct neighbors of actor on all layers.
+     * Only available if neighbors are tracked.
+     */
+    long
+    neighborhood(
+        const uu::net::Vertex* actor,
+        const uu::net::EdgeMode& mode
+    ) const;
+
+  private:
+
+    struct LayerStats
+    {
+        bool directed;
+        size_t num_edges;
+
+        // indexed by actor position; on undirected layers only out is used
+        std::vector<long> in;
+        std::vector<long> out;
+
+        // self-loops, counted both in in and out; only used on directed layers
+        std::vector<long> loops;
+    };
+
+    // number of edges (on any layer) between an actor and each of its neighbors
+    typedef std::unordered_map<const uu::net::Vertex*, long> NeighborCounts;
+
+    bool track_neighbors_;
+    bool invalid_;
+
+    std::unordered_map<const uu::net::Vertex*, size_t> actor_pos_;
+    size_t num_slots_;
+
+    std::unordered_map<const uu::net::Network*, LayerStats> layers_;
+
+    std::vector<NeighborCounts> in_neighbors_;
+    std::vector<NeighborCounts> out_neighbors_;
+    std::vector<NeighborCounts> all_neighbors_;
+
+    size_t
+    slot(
+        const uu::net::Vertex* actor
+    );
+
+    LayerStats&
+    layer_stats(
+        const uu::net::Network* layer
+    );
+
+    void
+    update(
+        const uu::net::Network* layer,
+        const uu::net::Vertex* v1,
+        const uu::net::Vertex* v2,
+        long delta
+    );
+
+    static void
+    count(
+        NeighborCounts& counts,
+        const uu::net::Vertex* neighbor,
+        long delta
+    );
+};
+
+#endif
@@ -0,0 +1,304 @@
+#include "ml_index.h"
+#include "parallel.h"
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+// Builds a CSR structure over n vertices from a list of (from, to) pairs. If symmetric
+// is true, every pair is also added in the opposite direction. Lists are sorted and
+// duplicates are removed.
+void
+fill_csr(
+    size_t n,
+    const std::vector<std::pair<int, int>>& pairs,
+    bool symmetric,
+    bool reversed,
+    std::vector<size_t>& start,
+    std::vector<int>& nbr
+)
+{
+    start.assign(n+1, 0);
+
+    for (auto p: pairs)
+    {
+        start[(reversed ? p.second : p.first) + 1]++;
+
+        if (symmetric)
+        {
+            start[p.second + 1]++;
+        }
+    }
+
+    for (size_t v = 0; v < n; v++)
+    {
+        start[v+1] += start[v];
+    }
+
+    nbr.resize(start[n]);
+    std::vector<size_t> pos(start.begin(), start.end() - 1);
+
+    for (auto p: pairs)
+    {
+        if (reversed)
+        {
+            nbr[pos[p.second]++] = p.first;
+        }
+        else
+        {
+            nbr[pos[p.first]++] = p.second;
+        }
+
+        if (symmetric)
+        {
+            nbr[pos[p.second]++] = p.first;
+        }
+    }
+
+    // sort and compact the lists, removing duplicates
+    size_t write = 0;
+
+    for (size_t v = 0; v < n; v++)
+    {
+        auto b = nbr.begin() + start[v];
+        auto e = nbr.begin() + start[v+1];
+        std::sort(b, e);
+        auto u = std::unique(b, e);
+
+        start[v] = write;
+
+        for (auto it = b; it != u; ++it)
+        {
+            nbr[write++] = *it;
+        }
+    }
+
+    start[n] = write;
+    nbr.resize(write);
+    nbr.shrink_to_fit();
+}
+
+// actors, layers with their offsets, and vertices of the index, processing the layers in
+// parallel; actor_pos is set to the position of each actor
+void
+index_vertices(
+    const uu::net::MultilayerNetwork* mnet,
+    size_t num_threads,
+    MLIndex& idx,
+    std::unordered_map<const uu::net::Vertex*, int>& actor_pos
+)
+{
+    actor_pos.reserve(mnet->actors()->size());
+
+    for (auto actor: *mnet->actors())
+    {
+        actor_pos[actor] = idx.actors.size();
+        idx.actors.push_back(actor);
+    }
+
+    std::vector<const uu::net::Network*> layers;
+
+    for (auto layer: *mnet->layers())
+    {
+        layers.push_back(layer);
+    }
+
+    idx.layers.resize(layers.size());
+    idx.vertex_of.resize(layers.size());
+
+    size_t num_vertices = 0;
+
+    for (size_t l = 0; l < layers.size(); l++)
+    {
+        idx.layers[l].layer = layers[l];
+        idx.layers[l].offset = num_vertices;
+        num_vertices += layers[l]->vertices()->size();
+    }
+
+    idx.num_vertices = num_vertices;
+
+    parallel_for(layers.size(), num_threads, [&](size_t l, size_t)
+    {
+        auto layer = layers[l];
+        LayerIndex& li = idx.layers[l];
+        std::vector<int>& pos = idx.vertex_of[l];
+
+        li.directed = layer->is_directed();
+        li.num_edges = layer->edges()->size();
+        li.num_loops = 0;
+        li.actor.reserve(layer->vertices()->size());
+        pos.assign(idx.actors.size(), -1);
+
+        for (auto vertex: *layer->vertices())
+        {
+            int a = actor_pos.at(vertex);
+            pos[a] = li.actor.size();
+            li.actor.push_back(a);
+        }
+    });
+}
+
+}
+
+size_t
+MLIndex::layer_of(
+    size_t v
+) const
+{
+    size_t lo = 0;
+    size_t hi = layers.size();
+
+    while (hi - lo > 1)
+    {
+        size_t mid = (lo + hi) / 2;
+
+        if (layers[mid].offset <= v)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+MLIndex
+build_vertex_index(
+    const uu::net::MultilayerNetwork* mnet,
+    size_t num_threads
+)
+{
+    MLIndex idx;
+    std::unordered_map<const uu::net::Vertex*, int> actor_pos;
+    index_vertices(mnet, num_threads, idx, actor_pos);
+    return idx;
+}
+
+MLIndex
+build_ml_index(
+    const uu::net::MultilayerNetwork* mnet,
+    size_t num_threads,
+    bool with_interlayer_edges
+)
+{
+    MLIndex idx;
+    std::unordered_map<const uu::net::Vertex*, int> actor_pos;
+    index_vertices(mnet, num_threads, idx, actor_pos);
+
+    parallel_for(idx.num_layers(), num_threads, [&](size_t l, size_t)
+    {
+        LayerIndex& li = idx.layers[l];
+        std::vector<int>& pos = idx.vertex_of[l];
+
+        std::vector<std::pair<int, int>> pairs;
+        pairs.reserve(li.num_edges);
+        li.loop.assign(li.actor.size(), 0);
+
+        for (auto edge: *li.layer->edges())
+        {
+            int v1 = pos[actor_pos.at(edge->v1)];
+            int v2 = pos[actor_pos.at(edge->v2)];
+
+            if (v1 == v2)
+            {
+                li.num_loops++;
+                li.loop[v1] = 1;
+                continue;
+            }
+
+            pairs.emplace_back(v1, v2);
+        }
+
+        size_t n = li.actor.size();
+
+        if (li.directed)
+        {
+            fill_csr(n, pairs, false, false, li.out_start, li.out_nbr);
+            fill_csr(n, pairs, false, true, li.in_start, li.in_nbr);
+        }
+        else
+        {
+            fill_csr(n, pairs, true, false, li.out_start, li.out_nbr);
+        }
+    });
+
+    if (with_interlayer_edges)
+    {
+        std::vector<const uu::net::Network*> layers;
+
+        for (auto& li: idx.layers)
+        {
+            layers.push_back(li.layer);
+        }
+
+        // same convention used in edges_idx(): the first vertex of an edge returned
+        // by get(l1,l2) is on l1
+        for (size_t i = 0; i < layers.size(); i++)
+        {
+            for (size_t j = 0; j < layers.size(); j++)
+            {
+                if (layers[j] <= layers[i])
+                {
+                    continue;
+                }
+
+                auto edges = mnet->interlayer_edges()->get(layers[i], layers[j]);
+
+                if (!edges)
+                {
+                    continue;
+                }
+
+                bool directed = mnet->interlayer_edges()->is_directed(layers[i], layers[j]);
+
+                for (auto edge: *edges)
+                {
+                    int v1 = idx.vertex_of[i][actor_pos.at(edge->v1)];
+                    int v2 = idx.vertex_of[j][actor_pos.at(edge->v2)];
+
+                    if (v1 < 0 || v2 < 0)
+                    {
+                        continue;
+                    }
+
+                    idx.interlayer.push_back(InterlayerEdge {idx.layers[i].offset + v1, idx.layers[j].offset + v2, directed});
+                }
+            }
+        }
+    }
+
+    return idx;
+}
+
+void
+undirected_adjacency(
+    const LayerIndex& layer,
+    std::vector<size_t>& start,
+    std::vector<int>& nbr
+)
+{
+    if (!layer.directed)
+    {
+        start = layer.out_start;
+        nbr = layer.out_nbr;
+        return;
+    }
+
+    size_t n = layer.num_vertices();
+    start.assign(n+1, 0);
+    nbr.clear();
+    nbr.reserve(layer.out_nbr.size() + layer.in_nbr.size());
+
+    for (size_t v = 0; v < n; v++)
+    {
+        std::set_union(layer.out_begin(v), layer.out_end(v),
+                       layer.in_begin(v), layer.in_end(v),
+                       std::back_inserter(nbr));
+        start[v+1] = nbr.size();
+    }
+}
@@ -0,0 +1,174 @@
+#ifndef UU_R_MULTINET_ML_INDEX_H_
+#define UU_R_MULTINET_ML_INDEX_H_
+
+#include <cstddef>
+#include <vector>
+#include "networks/MultilayerNetwork.hpp"
+
+/**
+ * Read-only compressed (CSR) snapshot of the adjacency of one layer.
+ *
+ * Vertices are identified by their position in the vertex store of the layer,
+ * so vertex i is layer->vertices()->at(i), and offset+i+1 is its identifier in the
+ * result of vertices_ml() and edges_idx_ml(). Neighbor lists are sorted, do not
+ * contain duplicates and do not contain self-loops. Undirected edges are stored in
+ * both directions in the out lists; the in lists are only filled for directed layers.
+ */
+struct LayerIndex
+{
+    const uu::net::Network* layer;
+    bool directed;
+    size_t offset;
+    size_t num_edges;
+    size_t num_loops;
+
+    // actor index (position in mnet->actors()) of each vertex
+    std::vector<int> actor;
+
+    // 1 for the vertices with a self-loop, which are not in the neighbor lists
+    std::vector<char> loop;
+
+    std::vector<size_t> out_start;
+    std::vector<int> out_nbr;
+    std::vector<size_t> in_start;
+    std::vector<int> in_nbr;
+
+    size_t
+    num_vertices(
+    ) const
+    {
+        return actor.size();
+    }
+
+    const int*
+    out_begin(
+        size_t v
+    ) const
+    {
+        return out_nbr.data() + out_start[v];
+    }
+
+    const int*
+    out_end(
+        size_t v
+    ) const
+    {
+        return out_nbr.data() + out_start[v+1];
+    }
+
+    size_t
+    out_degree(
+        size_t v
+    ) const
+    {
+        return out_start[v+1] - out_start[v];
+    }
+
+    const int*
+    in_begin(
+        size_t v
+    ) const
+    {
+        return directed ? in_nbr.data() + in_start[v] : out_begin(v);
+    }
+
+    const int*
+    in_end(
+        size_t v
+    ) const
+    {
+        return directed ? in_nbr.data() + in_start[v+1] : out_end(v);
+    }
+
+    size_t
+    in_degree(
+        size_t v
+    ) const
+    {
+        return directed ? in_start[v+1] - in_start[v] : out_degree(v);
+    }
+};
+
+/**
+ * Interlayer edge between two vertices, identified by their global position
+ * (as in vertices_ml()), starting from 0.
+ */
+struct InterlayerEdge
+{
+    size_t v1;
+    size_t v2;
+    bool directed;
+};
+
+/**
+ * Read-only integer snapshot of a multilayer network, used by the parallel
+ * algorithms that cannot work on the pointer-based uunet stores directly.
+ * Any modification of the network invalidates the index.
+ */
+struct MLIndex
+{
+    std::vector<const uu::net::Vertex*> actors;
+    std::vector<LayerIndex> layers;
+
+    // vertex_of[l][a]: position of actor a in layer l, or -1 if a is not in l
+    std::vector<std::vector<int>> vertex_of;
+
+    std::vector<InterlayerEdge> interlayer;
+
+    size_t num_vertices;
+
+    size_t
+    num_actors(
+    ) const
+    {
+        return actors.size();
+    }
+
+    size_t
+    num_layers(
+    ) const
+    {
+        return layers.size();
+    }
+
+    // layer containing the vertex with global position v
+    size_t
+    layer_of(
+        size_t v
+    ) const;
+};
+
+/**
+ * Builds the index of all layers of mnet, processing the layers in parallel.
+ * Interlayer edges are only indexed if with_interlayer_edges is true.
+ */
+MLIndex
+build_ml_index(
+    const uu::net::MultilayerNetwork* mnet,
+    size_t num_threads,
+    bool with_interlayer_edges = false
+);
+
+/**
+ * Builds the part of the index of mnet about vertices (actors, layers with their offsets
+ * and vertices, and vertex_of) without indexing the edges, for the functions that only
+ * convert between vertices and their global positions. The adjacency lists are empty.
+ */
+MLIndex
+build_vertex_index(
+    const uu::net::MultilayerNetwork* mnet,
+    size_t num_threads
+);
+
+/**
+ * Computes the undirected adjacency of a layer (union of in and out neighbors),
+ * in the same CSR format used by LayerIndex.
+ */
+void
+undirected_adjacency(
+    const LayerIndex& layer,
+    std::vector<size_t>& start,
+    std::vector<int>& nbr
+);
+
+#endif
@@ -0,0 +1,228 @@
+#include "occupation.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// block size of the parallel loops: partial sums are computed per block and added
+// in block order, so that results do not depend on the number of threads
+const size_t BLOCK = 4096;
+
+size_t
+num_blocks(
+    size_t n
+)
+{
+    return (n + BLOCK - 1) / BLOCK;
+}
+
+double
+sum_in_order(
+    const std::vector<double>& partial
+)
+{
+    double res = 0;
+
+    for (auto p: partial)
+    {
+        res += p;
+    }
+
+    return res;
+}
+
+}
+
+Occupation
+occupation(
+    const MLIndex& idx,
+    const std::vector<double>& transitions,
+    double teleportation,
+    double tol,
+    size_t max_iterations,
+    size_t num_threads
+)
+{
+    size_t N = idx.num_vertices;
+    size_t A = idx.num_actors();
+    size_t L = idx.num_layers();
+
+    Occupation res;
+    res.iterations = 0;
+    res.residual = 0;
+    res.actor.assign(A, 0);
+
+    if (N == 0)
+    {
+        return res;
+    }
+
+    // vertices of each actor (global ids) and their layers
+
+    std::vector<size_t> actor_start(A + 1, 0);
+    std::vector<size_t> actor_vertex;
+    std::vector<size_t> actor_layer;
+    actor_vertex.reserve(N);
+    actor_layer.reserve(N);
+
+    for (size_t a = 0; a < A; a++)
+    {
+        for (size_t l = 0; l < L; l++)
+        {
+            int v = idx.vertex_of[l][a];
+
+            if (v >= 0)
+            {
+                actor_vertex.push_back(idx.layers[l].offset + v);
+                actor_layer.push_back(l);
+            }
+        }
+
+        actor_start[a+1] = actor_vertex.size();
+    }
+
+    // inverse out-degree of each vertex, and inverse of the total weight of the layers
+    // the walker can move to from each vertex (0 if none: dangling vertex)
+
+    std::vector<double> inv_degree(N, 0);
+    std::vector<double> inv_weight(N, 0);
+
+    for (auto& layer: idx.layers)
+    {
+        for (size_t v = 0; v < layer.num_vertices(); v++)
+        {
+            if (layer.out_degree(v) > 0)
+            {
+                inv_degree[layer.offset + v] = 1.0 / layer.out_degree(v);
+            }
+        }
+    }
+
+    for (size_t a = 0; a < A; a++)
+    {
+        for (size_t i = actor_start[a]; i < actor_start[a+1]; i++)
+        {
+            double weight = 0;
+
+            for (size_t j = actor_start[a]; j < actor_start[a+1]; j++)
+            {
+                if (inv_degree[actor_vertex[j]] > 0)
+                {
+                    weight += transitions[actor_layer[i] * L + actor_layer[j]];
+                }
+            }
+
+            inv_weight[actor_vertex[i]] = weight > 0 ? 1 / weight : 0;
+        }
+    }
+
+    // power iteration
+
+    std::vector<double> x(N, 1.0 / N);
+    std::vector<double> x_next(N);
+    std::vector<double> z(N);
+
+    size_t actor_blocks = num_blocks(A);
+    size_t vertex_blocks = num_blocks(N);
+    std::vector<double> dangling(actor_blocks);
+    std::vector<double> residual(vertex_blocks);
+
+    while (res.iterations < max_iterations)
+    {
+        // probability leaving each vertex along each of its edges
+
+        parallel_for(actor_blocks, num_threads, [&](size_t b, size_t)
+        {
+            double d = 0;
+            size_t end = std::min(A, (b + 1) * BLOCK);
+
+            for (size_t a = b * BLOCK; a < end; a++)
+            {
+                for (size_t j = actor_start[a]; j < actor_start[a+1]; j++)
+                {
+                    size_t target = actor_vertex[j];
+
+                    if (inv_degree[target] == 0)
+                    {
+                        z[target] = 0;
+                        continue;
+                    }
+
+                    double y = 0;
+
+                    for (size_t i = actor_start[a]; i < actor_start[a+1]; i++)
+                    {
+                        size_t source = actor_vertex[i];
+                        y += x[source] * inv_weight[source] * transitions[actor_layer[i] * L + actor_layer[j]];
+                    }
+
+                    z[target] = y * inv_degree[target];
+                }
+
+                for (size_t i = actor_start[a]; i < actor_start[a+1]; i++)
+                {
+                    if (inv_weight[actor_vertex[i]] == 0)
+                    {
+                        d += x[actor_vertex[i]];
+                    }
+                }
+            }
+
+            dangling[b] = d;
+        });
+
+        double base = (teleportation + (1 - teleportation) * sum_in_order(dangling)) / N;
+
+        // propagation along the edges of each layer
+
+        parallel_for(vertex_blocks, num_threads, [&](size_t b, size_t)
+        {
+            double r = 0;
+            size_t end = std::min(N, (b + 1) * BLOCK);
+            size_t l = idx.layer_of(b * BLOCK);
+
+            for (size_t w = b * BLOCK; w < end; w++)
+            {
+                while (w >= idx.layers[l].offset + idx.layers[l].num_vertices())
+                {
+                    l++;
+                }
+
+                const LayerIndex& layer = idx.layers[l];
+                size_t v = w - layer.offset;
+                double s = 0;
+
+                for (const int* p = layer.in_begin(v); p != layer.in_end(v); ++p)
+                {
+                    s += z[layer.offset + *p];
+                }
+
+                x_next[w] = (1 - teleportation) * s + base;
+                r += std::fabs(x_next[w] - x[w]);
+            }
+
+            residual[b] = r;
+        });
+
+        x.swap(x_next);
+        res.iterations++;
+        res.residual = sum_in_order(residual);
+
+        if (res.residual <= tol)
+        {
+            break;
+        }
+    }
+
+    for (size_t a = 0; a < A; a++)
+    {
+        for (size_t i = actor_start[a]; i < actor_start[a+1]; i++)
+        {
+            res.actor[a] += x[actor_vertex[i]];
+        }
+    }
+
+    res.vertex.swap(x);
+    return res;
+}
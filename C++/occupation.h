@@ -0,0 +1,53 @@
+#ifndef UU_R_MULTINET_OCCUPATION_H_
+#define UU_R_MULTINET_OCCUPATION_H_
+
+#include <cstddef>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Stationary distribution of a multilayer random walk with teleportation.
+ */
+struct Occupation
+{
+    // probability of each vertex (global id)
+    std::vector<double> vertex;
+
+    // probability of each actor (sum over its vertices)
+    std::vector<double> actor;
+
+    size_t iterations;
+
+    // L1 distance between the last two iterates
+    double residual;
+};
+
+/**
+ * Computes the occupation centrality by power iteration.
+ *
+ * The walker is on a vertex, that is, on an actor a in a layer l. At each step, with
+ * probability teleportation it jumps to a uniformly random vertex. Otherwise it chooses a
+ * layer l' with probability proportional to transitions[l*L+l'], among the layers where a
+ * has at least one (outgoing) neighbor, and moves to a uniformly random neighbor of a on l'.
+ * If a has no neighbor on any layer reachable from l, the walker teleports.
+ *
+ * The supra-transition matrix is not built explicitly: each iteration first distributes
+ * the probability of each actor over its layers, then propagates it along the edges of
+ * each layer (one sparse matrix-vector product per layer, on the incoming adjacency lists).
+ * Both steps are parallel, and sums are computed in a fixed order so that the result
+ * does not depend on the number of threads.
+ *
+ * The iteration stops when the L1 distance between two iterates is at most tol, or after
+ * max_iterations iterations.
+ */
+Occupation
+occupation(
+    const MLIndex& idx,
+    const std::vector<double>& transitions,
+    double teleportation,
+    double tol,
+    size_t max_iterations,
+    size_t num_threads
+);
+
+#endif
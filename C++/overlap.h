@@ -0,0 +1,58 @@
+#ifndef UU_R_MULTINET_OVERLAP_H_
+#define UU_R_MULTINET_OVERLAP_H_
+
+#include <string>
+#include "core/exceptions/WrongParameterException.hpp"
+
+/**
+ * Overlapping-based similarity between two contexts (e.g., layers), computed from the
+ * number of structures (actors, edges, triangles) in both contexts (a), only in the first (b),
+ * only in the second (c) and in neither of them (d).
+ *
+ * function can be "jaccard", "coverage" (fraction of the structures of the first context
+ * also present in the second), "kulczynski2", "sm" (simple matching), "rr" (Russell-Rao)
+ * or "hamann".
+ */
+inline double
+overlap_similarity(
+    const std::string& function,
+    double a,
+    double b,
+    double c,
+    double d
+)
+{
+    if (function == "jaccard")
+    {
+        return a / (a + b + c);
+    }
+
+    else if (function == "coverage")
+    {
+        return a / (a + b);
+    }
+
+    else if (function == "kulczynski2")
+    {
+        return (a / (a + b) + a / (a + c)) / 2;
+    }
+
+    else if (function == "sm")
+    {
+        return (a + d) / (a + b + c + d);
+    }
+
+    else if (function == "rr")
+    {
+        return a / (a + b + c + d);
+    }
+
+    else if (function == "hamann")
+    {
+        return (a + d - b - c) / (a + b + c + d);
+    }
+
+    throw uu::core::WrongParameterException("unexpected value: similarity function " + function);
+}
+
+#endif
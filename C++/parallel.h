@@ -0,0 +1,124 @@
+#ifndef UU_R_MULTINET_PARALLEL_H_
+#define UU_R_MULTINET_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Returns the number of worker threads to use: num_threads if positive,
+ * otherwise the number of hardware threads (at least 1).
+ */
+inline size_t
+resolve_num_threads(
+    int num_threads
+)
+{
+    if (num_threads > 0)
+    {
+        return (size_t)num_threads;
+    }
+
+    size_t hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+/**
+ * Executes f(task, thread_id) for every task in [0, num_tasks), distributing the tasks
+ * dynamically over num_threads threads in chunks of grain tasks.
+ *
+ * f must not call the R API. The first exception thrown by a task stops the
+ * distribution of new tasks and is rethrown in the calling thread.
+ */
+template <typename F>
+void
+parallel_for(
+    size_t num_tasks,
+    size_t num_threads,
+    F f,
+    size_t grain = 1
+)
+{
+    if (num_tasks == 0)
+    {
+        return;
+    }
+
+    grain = std::max<size_t>(grain, 1);
+    num_threads = std::max<size_t>(1, std::min(num_threads, (num_tasks + grain - 1) / grain));
+
+    if (num_threads == 1)
+    {
+        for (size_t task = 0; task < num_tasks; task++)
+        {
+            f(task, 0);
+        }
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](size_t thread_id)
+    {
+        try
+        {
+            while (!failed.load(std::memory_order_relaxed))
+            {
+                size_t begin = next.fetch_add(grain);
+
+                if (begin >= num_tasks)
+                {
+                    break;
+                }
+
+                size_t end = std::min(begin + grain, num_tasks);
+
+                for (size_t task = begin; task < end; task++)
+                {
+                    f(task, thread_id);
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+
+    for (size_t t = 1; t < num_threads; t++)
+    {
+        threads.emplace_back(worker, t);
+    }
+
+    worker(0);
+
+    for (auto& t: threads)
+    {
+        t.join();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif
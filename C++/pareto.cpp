@@ -0,0 +1,318 @@
+#include "pareto.h"
+#include "parallel.h"
+#include <algorithm>
+#include <memory>
+
+ParetoBFS::
+ParetoBFS(
+    const MLIndex& idx
+) : idx_(idx), num_layers_(idx.num_layers()), frontier_(idx.num_actors())
+{
+}
+
+bool
+ParetoBFS::
+dominated(
+    const uint32_t* length,
+    int actor
+) const
+{
+    for (auto label: frontier_[actor])
+    {
+        const uint32_t* other = label_length_.data() + (size_t)label * num_layers_;
+        bool leq = true;
+
+        for (size_t l = 0; l < num_layers_; l++)
+        {
+            if (other[l] > length[l])
+            {
+                leq = false;
+                break;
+            }
+        }
+
+        if (leq)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool
+ParetoBFS::
+settled(
+    int target,
+    const std::vector<uint32_t>& queue
+) const
+{
+    // all future paths extend a path in the queue, so they are dominated
+    // at the target if their prefixes are
+    for (auto label: queue)
+    {
+        if (!dominated(label_length_.data() + (size_t)label * num_layers_, target))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+ParetoBFS::
+run(
+    int source,
+    const std::vector<int>& targets,
+    size_t max_length,
+    ParetoDistances& res
+)
+{
+    size_t L = num_layers_;
+
+    for (auto actor: touched_)
+    {
+        frontier_[actor].clear();
+    }
+
+    touched_.clear();
+    label_actor_.clear();
+    label_length_.clear();
+
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> candidate(L);
+
+    label_actor_.push_back(source);
+    label_length_.resize(L, 0);
+    frontier_[source].push_back(0);
+    touched_.push_back(source);
+    queue.push_back(0);
+
+    std::vector<int> unsettled(targets);
+    size_t steps = 0;
+
+    while (!queue.empty())
+    {
+        if (!targets.empty())
+        {
+            size_t num_unsettled = 0;
+
+            for (auto target: unsettled)
+            {
+                if (!settled(target, queue))
+                {
+                    unsettled[num_unsettled++] = target;
+                }
+            }
+
+            unsettled.resize(num_unsettled);
+
+            if (unsettled.empty())
+            {
+                break;
+            }
+        }
+
+        if (max_length > 0 && steps == max_length)
+        {
+            break;
+        }
+
+        next.clear();
+
+        for (auto label: queue)
+        {
+            int actor = label_actor_[label];
+
+            for (size_t l = 0; l < L; l++)
+            {
+                int v = idx_.vertex_of[l][actor];
+
+                if (v < 0)
+                {
+                    continue;
+                }
+
+                const LayerIndex& layer = idx_.layers[l];
+
+                for (const int* n = layer.out_begin(v); n != layer.out_end(v); ++n)
+                {
+                    int neighbor = layer.actor[*n];
+
+                    std::copy(label_length_.begin() + (size_t)label * L,
+                              label_length_.begin() + (size_t)(label + 1) * L,
+                              candidate.begin());
+                    candidate[l]++;
+
+                    if (dominated(candidate.data(), neighbor))
+                    {
+                        continue;
+                    }
+
+                    uint32_t id = label_actor_.size();
+                    label_actor_.push_back(neighbor);
+                    label_length_.insert(label_length_.end(), candidate.begin(), candidate.end());
+
+                    if (frontier_[neighbor].empty())
+                    {
+                        touched_.push_back(neighbor);
+                    }
+
+                    frontier_[neighbor].push_back(id);
+                    next.push_back(id);
+                }
+            }
+        }
+
+        queue.swap(next);
+        steps++;
+    }
+
+    res.num_layers = L;
+
+    auto append = [&](int actor)
+    {
+        for (auto label: frontier_[actor])
+        {
+            res.target.push_back(actor);
+            res.lengths.insert(res.lengths.end(),
+                               label_length_.begin() + (size_t)label * L,
+                               label_length_.begin() + (size_t)(label + 1) * L);
+        }
+    };
+
+    if (targets.empty())
+    {
+        for (size_t actor = 0; actor < idx_.num_actors(); actor++)
+        {
+            append(actor);
+        }
+    }
+    else
+    {
+        for (auto target: targets)
+        {
+            append(target);
+        }
+    }
+}
+
+size_t
+ParetoBFS::
+memory(
+) const
+{
+    size_t bytes = label_actor_.capacity() * sizeof(int) +
+                   label_length_.capacity() * sizeof(uint32_t) +
+                   frontier_.capacity() * sizeof(std::vector<uint32_t>) +
+                   touched_.capacity() * sizeof(int);
+
+    for (auto& labels: frontier_)
+    {
+        bytes += labels.capacity() * sizeof(uint32_t);
+    }
+
+    return bytes;
+}
+
+namespace {
+
+void
+run_block(
+    const MLIndex& idx,
+    const std::vector<int>& sources,
+    size_t first,
+    const std::vector<int>& targets,
+    size_t max_length,
+    std::vector<std::unique_ptr<ParetoBFS>>& engines,
+    std::vector<ParetoDistances>& res
+)
+{
+    parallel_for(res.size(), engines.size(), [&](size_t i, size_t t)
+    {
+        if (!engines[t])
+        {
+            engines[t].reset(new ParetoBFS(idx));
+        }
+
+        res[i].clear();
+        engines[t]->run(sources[first + i], targets, max_length, res[i]);
+    });
+}
+
+}
+
+std::vector<ParetoDistances>
+pareto_distances(
+    const MLIndex& idx,
+    const std::vector<int>& sources,
+    const std::vector<int>& targets,
+    size_t max_length,
+    size_t num_threads
+)
+{
+    std::vector<ParetoDistances> res(sources.size());
+    std::vector<std::unique_ptr<ParetoBFS>> engines(std::max<size_t>(num_threads, 1));
+    run_block(idx, sources, 0, targets, max_length, engines, res);
+    return res;
+}
+
+void
+pareto_distances_by_block(
+    const MLIndex& idx,
+    const std::vector<int>& sources,
+    const std::vector<int>& targets,
+    size_t max_length,
+    size_t num_threads,
+    size_t block_bytes,
+    const std::function<void(size_t, const std::vector<ParetoDistances>&)>& consume
+)
+{
+    num_threads = std::max<size_t>(num_threads, 1);
+    std::vector<std::unique_ptr<ParetoBFS>> engines(num_threads);
+    std::vector<ParetoDistances> block;
+    size_t row_bytes = sizeof(int) + idx.num_layers() * sizeof(uint32_t);
+
+    // largest memory taken by the distances from one source, so far
+    size_t source_bytes = 0;
+
+    for (size_t first = 0; first < sources.size(); first += block.size())
+    {
+        // the searches keep their largest working memory between runs
+        size_t engine_bytes = 0;
+
+        for (auto& engine: engines)
+        {
+            engine_bytes += engine ? engine->memory() : 0;
+        }
+
+        size_t block_size = num_threads;
+
+        if (source_bytes > 0 && block_bytes > engine_bytes)
+        {
+            block_size = std::max(block_size, (block_bytes - engine_bytes) / source_bytes);
+        }
+
+        // the distances of the previous block are released, so that their capacity is
+        // not kept on top of the new ones
+        block.resize(std::min(block_size, sources.size() - first));
+
+        for (auto& d: block)
+        {
+            d.clear();
+            d.target.shrink_to_fit();
+            d.lengths.shrink_to_fit();
+        }
+
+        run_block(idx, sources, first, targets, max_length, engines, block);
+
+        consume(first, block);
+
+        for (auto& d: block)
+        {
+            source_bytes = std::max(source_bytes, d.size() * row_bytes);
+        }
+    }
+}
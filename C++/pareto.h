@@ -0,0 +1,137 @@
+#ifndef UU_R_MULTINET_PARETO_H_
+#define UU_R_MULTINET_PARETO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Non-dominated (Pareto) multiplex distances from one source actor.
+ * Distance i goes to actor target[i] and its number of steps on layer l is
+ * lengths[i*num_layers+l].
+ */
+struct ParetoDistances
+{
+    size_t num_layers;
+    std::vector<int> target;
+    std::vector<uint32_t> lengths;
+
+    size_t
+    size(
+    ) const
+    {
+        return target.size();
+    }
+
+    void
+    clear(
+    )
+    {
+        target.clear();
+        lengths.clear();
+    }
+};
+
+/**
+ * Single-source multiplex Pareto distance.
+ *
+ * Paths are expanded one step at a time (breadth-first on the total number of steps), so
+ * a new path length at an actor is non-dominated if and only if it is not dominated by
+ * (or equal to) one of the lengths already found for that actor. The search stops as soon
+ * as all requested targets are settled, that is, when every path still to be expanded is
+ * dominated at each target, or when the maximum number of steps is reached.
+ *
+ * An object keeps its working memory between runs and is not thread-safe: use one object
+ * per thread.
+ */
+class ParetoBFS
+{
+  public:
+
+    explicit
+    ParetoBFS(
+        const MLIndex& idx
+    );
+
+    /**
+     * Computes the distances from source to targets (all actors if targets is empty),
+     * considering paths of at most max_length steps (no limit if 0).
+     * Results are appended to res grouped by target, in the order of targets.
+     */
+    void
+    run(
+        int source,
+        const std::vector<int>& targets,
+        size_t max_length,
+        ParetoDistances& res
+    );
+
+    /**
+     * Bytes of working memory kept by the object, which grows with the largest number
+     * of labels found in a run.
+     */
+    size_t
+    memory(
+    ) const;
+
+  private:
+
+    const MLIndex& idx_;
+    size_t num_layers_;
+
+    // labels: actor and length on each layer of each path found
+    std::vector<int> label_actor_;
+    std::vector<uint32_t> label_length_;
+
+    // non-dominated labels at each actor
+    std::vector<std::vector<uint32_t>> frontier_;
+    std::vector<int> touched_;
+
+    bool
+    dominated(
+        const uint32_t* length,
+        int actor
+    ) const;
+
+    bool
+    settled(
+        int target,
+        const std::vector<uint32_t>& queue
+    ) const;
+};
+
+/**
+ * Runs ParetoBFS from each source in parallel. Results are returned in the order of sources.
+ */
+std::vector<ParetoDistances>
+pareto_distances(
+    const MLIndex& idx,
+    const std::vector<int>& sources,
+    const std::vector<int>& targets,
+    size_t max_length,
+    size_t num_threads
+);
+
+/**
+ * Runs ParetoBFS from all sources in blocks, calling consume(first, block) on the calling
+ * thread after each block, where block[i] contains the distances from sources[first+i].
+ * Before each block, its size is chosen so that the working memory of the searches (one
+ * per thread) and the distances of the block fit in block_bytes, estimating the distances
+ * of a source as the largest ones seen so far; a block contains at least one source per
+ * thread. This bounds the memory used when the consumer streams the results somewhere
+ * else, up to the sources with more distances than those already processed.
+ */
+void
+pareto_distances_by_block(
+    const MLIndex& idx,
+    const std::vector<int>& sources,
+    const std::vector<int>& targets,
+    size_t max_length,
+    size_t num_threads,
+    size_t block_bytes,
+    const std::function<void(size_t, const std::vector<ParetoDistances>&)>& consume
+);
+
+#endif
@@ -1,18 +1,13 @@
 #include <sstream>
+#include <fstream>
+#include <cmath>
+#include <map>
 #include "r_functions.h"
 #include "rcpp_utils.h"
 
 #include "operations/union.hpp"
 #include "operations/project.hpp"
-#include "community/glouvain2.hpp"
-#include "community/abacus.hpp"
-
-#include "community/flat.hpp"
-#include "community/mlp.hpp"
-#include "community/mlcpm.hpp"
-#include "community/modularity.hpp"
-#include "community/nmi.hpp"
-#include "community/omega_index.hpp"
+
 #include "io/read_multilayer_network.hpp"
 #include "io/write_multilayer_network.hpp"
 #include "measures/degree_ml.hpp"
@@ -28,6 +23,26 @@
 #include "core/propertymatrix/summarization.hpp"
 #include "layout/multiforce.hpp"
 #include "layout/circular.hpp"
+#include "parallel.h"
+#include "ml_index.h"
+#include "triangles.h"
+#include "overlap.h"
+#include "sketches.h"
+#include "pareto.h"
+#include "centrality.h"
+#include "occupation.h"
+#include "walks.h"
+#include "top_actors.h"
+#include "cores.h"
+#include "components.h"
+#include "layer_stats.h"
+#include "abacus.h"
+#include "cliques.h"
+#include "comparison.h"
+#include "consensus.h"
+#include "glouvain.h"
+#include "flat_view.h"
+#include "label_propagation.h"
 
 using namespace Rcpp;
 
@@ -998,6 +1013,7 @@ addEdges(
 )
 {
     auto mnet = rmnet.get_mlnet();
+    auto stats = rmnet.live_stats();
 
     CharacterVector a_from = edges(0);
     CharacterVector l_from = edges(1);
@@ -1040,7 +1056,20 @@ addEdges(
 
         if (layer1==layer2)
         {
-            layer1->edges()->add(actor1, actor2);
+            if (stats && !layer1->edges()->get(actor1, actor2))
+            {
+                auto e = layer1->edges()->add(actor1, actor2);
+
+                if (e)
+                {
+                    stats->add_edge(layer1, e->v1, e->v2);
+                }
+            }
+
+            else
+            {
+                layer1->edges()->add(actor1, actor2);
+            }
         }
 
         else
@@ -1123,6 +1152,11 @@ deleteLayers(
         auto layer = mnet->layers()->get(std::string(layer_names(i)));
         mnet->layers()->erase(layer);
     }
+
+    if (rmnet.live_stats())
+    {
+        rmnet.live_stats()->invalidate();
+    }
     return;
 }
 
@@ -1134,9 +1168,15 @@ deleteActors(
 {
     auto mnet = rmnet.get_mlnet();
     auto actors = resolve_actors(mnet, actor_names);
-    
+    auto stats = rmnet.live_stats();
+
     for (auto actor: actors)
     {
+        if (stats)
+        {
+            stats->erase_actor(mnet, actor);
+        }
+
         mnet->actors()->erase(actor);
     }
     return;
@@ -1150,11 +1190,18 @@ deleteNodes(
 {
     auto mnet = rmnet.get_mlnet();
     auto vertices = resolve_vertices(mnet, vertex_matrix);
+    auto stats = rmnet.live_stats();
 
     for (auto vertex: vertices)
     {
         auto actor = vertex.first;
         auto layer = vertex.second;
+
+        if (stats)
+        {
+            stats->erase_vertex(layer, actor);
+        }
+
         layer->vertices()->erase(actor);
     }
     return;
@@ -1168,6 +1215,7 @@ deleteEdges(
 {
     auto mnet = rmnet.get_mlnet();
     auto edges = resolve_edges(mnet, edge_matrix);
+    auto stats = rmnet.live_stats();
 
     for (auto edge: edges)
     {
@@ -1178,6 +1226,12 @@ deleteEdges(
         if (layer1 == layer2)
         {
             auto e = layer1->edges()->get(actor1, actor2);
+
+            if (stats && e)
+            {
+                stats->erase_edge(layer1, e->v1, e->v2);
+            }
+
             layer1->edges()->erase(e);
         }
         else
@@ -1189,6 +1243,25 @@ deleteEdges(
     return;
 }
 
+void
+live_stats_ml(
+    RMLNetwork& rmnet,
+    bool enable,
+    bool neighbors
+)
+{
+    if (enable)
+    {
+        rmnet.set_live_stats(std::make_shared<LiveStats>(rmnet.get_mlnet(), neighbors));
+    }
+
+    else
+    {
+        rmnet.set_live_stats(nullptr);
+    }
+    return;
+}
+
 
 void
 newAttributes(
@@ -2154,12 +2227,31 @@ degree_ml(
     auto layers = resolve_layers_unordered(mnet,layer_names);
     NumericVector res(actors.size());
 
+    auto stats = rmnet.live_stats();
+
+    if (stats && !stats->valid(mnet))
+    {
+        stats->rebuild(mnet);
+    }
+
     size_t i = 0;
     for (auto actor: actors)
     {
         long deg = 0;
         auto mode = resolve_mode(type);
-        deg = degree(layers.begin(), layers.end(), actor, mode);
+
+        if (stats)
+        {
+            for (auto layer: layers)
+            {
+                deg += stats->degree(layer, actor, mode);
+            }
+        }
+
+        else
+        {
+            deg = degree(layers.begin(), layers.end(), actor, mode);
+        }
 
         if (deg==0)
         {
@@ -2250,40 +2342,76 @@ degree_deviation_ml(
     return res;
 }
 
-/*
-NumericVector occupation_ml(
-    const RMLNetwork& rmnet, const NumericMatrix& transitions, double teleportation, long steps) {
-auto mnet = rmnet.get_mlnet();
+NumericVector
+occupation_ml(
+    const RMLNetwork& rmnet,
+    const NumericMatrix& transitions,
+    double teleportation,
+    double tol,
+    int max_iter,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    size_t num_layers = mnet->layers()->size();
 
-if (steps==0) {
-    // completely arbitrary value :)
-    steps = 100*mnet->get_edges()->size();
-}
-if (transitions.nrow()!=transitions.ncol()) {
-    stop("expected NxN matrix");
-}
-if (transitions.nrow()!=mnet->get_layers()->size()) {
-    stop("dimensions of transition probability matrix do not match the number of layers in the network");
-}
-matrix<double> m(transitions.nrow());
-for (size_t i=0; i<transitions.nrow(); i++) {
-    std::vector<double> row(transitions.ncol());
-    for (size_t j=0; j<transitions.ncol(); j++) {
-        row[j] = transitions(i,j);
+    if (transitions.nrow()!=transitions.ncol())
+    {
+        stop("expected NxN matrix");
     }
-    m[i] = row;
-}
 
-NumericVector res(actors.size());
-std::unordered_map<const uu::net::Vertex*, int > occ = occupation(mnet,teleportation,m,steps);
+    if ((size_t)transitions.nrow()!=num_layers)
+    {
+        stop("dimensions of transition probability matrix do not match the number of layers in the network");
+    }
 
-for (const auto &p : occ) {
-    res[p.first->name] = p.second;
-}
-return res;
-}
+    if (teleportation < 0 || teleportation > 1)
+    {
+        stop("teleportation must be between 0 and 1");
+    }
 
-*/
+    if (tol <= 0 || max_iter <= 0)
+    {
+        stop("tol and max.iter must be positive");
+    }
+
+    std::vector<double> m(num_layers * num_layers);
+
+    for (size_t i=0; i<num_layers; i++)
+    {
+        for (size_t j=0; j<num_layers; j++)
+        {
+            if (!(transitions(i,j) >= 0) || std::isinf(transitions(i,j)))
+            {
+                stop("transition probabilities must be non-negative numbers");
+            }
+
+            m[i*num_layers+j] = transitions(i,j);
+        }
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    auto occ = occupation(idx, m, teleportation, tol, max_iter, num_threads);
+
+    if (occ.residual > tol)
+    {
+        Rcout << "Warning: power iteration not converged after " << occ.iterations << " iterations" << std::endl;
+    }
+
+    NumericVector res(idx.num_actors());
+    CharacterVector names(idx.num_actors());
+
+    for (size_t a=0; a<idx.num_actors(); a++)
+    {
+        res[a] = occ.actor[a];
+        names[a] = idx.actors[a]->name;
+    }
+
+    res.attr("names") = names;
+    res.attr("iterations") = (int)occ.iterations;
+    return res;
+}
 
 NumericVector
 neighborhood_ml(
@@ -2299,12 +2427,34 @@ neighborhood_ml(
     auto layers = resolve_layers_unordered(mnet,layer_names);
     NumericVector res(actors.size());
 
+    // neighbors are only tracked on the union of all the layers
+    auto stats = rmnet.live_stats();
+
+    if (stats && (!stats->tracks_neighbors() || layers.size() != mnet->layers()->size()))
+    {
+        stats = nullptr;
+    }
+
+    if (stats && !stats->valid(mnet))
+    {
+        stats->rebuild(mnet);
+    }
+
     size_t i = 0;
     for (auto actor: actors)
     {
         long neigh = 0;
         auto mode = resolve_mode(type);
-        neigh = neighbors(layers.begin(), layers.end(), actor, mode).size();
+
+        if (stats)
+        {
+            neigh = stats->neighborhood(actor, mode);
+        }
+
+        else
+        {
+            neigh = neighbors(layers.begin(), layers.end(), actor, mode).size();
+        }
 
         if (neigh==0)
         {
@@ -2561,13 +2711,93 @@ xrelevance_ml(
     return res;
 }
 
+DataFrame
+top_actors_ml(
+    const RMLNetwork& rmnet,
+    const std::string& measure,
+    const CharacterVector& layer_names,
+    int k,
+    const std::string& type,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto layers = resolve_const_layers(mnet,layer_names);
+    auto mode = resolve_mode(type);
+
+    ActorMeasure m;
+
+    if (measure=="degree")
+    {
+        m = ActorMeasure::DEGREE;
+    }
+
+    else if (measure=="neighborhood")
+    {
+        m = ActorMeasure::NEIGHBORHOOD;
+    }
+
+    else if (measure=="xneighborhood")
+    {
+        m = ActorMeasure::XNEIGHBORHOOD;
+    }
+
+    else if (measure=="relevance")
+    {
+        m = ActorMeasure::RELEVANCE;
+    }
+
+    else if (measure=="xrelevance")
+    {
+        m = ActorMeasure::XRELEVANCE;
+    }
+
+    else
+    {
+        stop("Unexpected value: measure");
+    }
+
+    if (k < 0)
+    {
+        stop("k must be non-negative");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    std::vector<size_t> layer_idx;
+
+    for (auto layer: layers)
+    {
+        layer_idx.push_back(mnet->layers()->index_of(layer));
+    }
+
+    auto top = top_actors(idx, layer_idx, m,
+                          mode != uu::net::EdgeMode::IN, mode != uu::net::EdgeMode::OUT,
+                          k, num_threads);
+
+    CharacterVector actor_n(top.size());
+    NumericVector value_n(top.size());
+
+    for (size_t i=0; i<top.size(); i++)
+    {
+        actor_n[i] = idx.actors[top[i].actor]->name;
+        value_n[i] = top[i].value;
+    }
+
+    return DataFrame::create(_["actor"] = actor_n, _["value"] = value_n);
+}
+
 DataFrame
 comparison_ml(
     const RMLNetwork& rmnet,
     const CharacterVector& layer_names,
     const std::string& method,
     const std::string& type,
-    int K
+    int K,
+    bool approx,
+    int sketch_size,
+    int threads
 )
 {
 
@@ -2583,7 +2813,67 @@ comparison_ml(
 
     DataFrame res = DataFrame::create();
 
-    if (method=="jaccard.actors")
+    if (approx)
+    {
+        std::string function = method.substr(0, method.find('.'));
+        std::string structures = method.substr(method.find('.')+1);
+
+        if (structures != "actors" && structures != "edges")
+        {
+            stop("approximate comparison only available for overlapping methods on actors and edges");
+        }
+
+        if (sketch_size <= 1)
+        {
+            stop("sketch.size must be larger than 1");
+        }
+
+        std::vector<const G*> all_layers;
+
+        for (auto layer: *mnet->layers())
+        {
+            all_layers.push_back(layer);
+        }
+
+        size_t num_threads = resolve_num_threads(threads);
+        auto sketches = structures == "actors" ?
+                        actor_sketches(mnet, all_layers, sketch_size, num_threads) :
+                        edge_sketches(mnet, all_layers, sketch_size, num_threads);
+
+        std::vector<const BottomKSketch*> all_sketches;
+
+        for (auto& sketch: sketches)
+        {
+            all_sketches.push_back(&sketch);
+        }
+
+        double num_structures = structures == "actors" ?
+                                mnet->actors()->size() :
+                                estimate_union_size(all_sketches);
+
+        for (size_t j=0; j<layers.size(); j++)
+        {
+            size_t l2 = mnet->layers()->index_of(layers[j]);
+            double size2 = structures == "actors" ? layers[j]->vertices()->size() : layers[j]->edges()->size();
+
+            for (size_t i=0; i<layers.size(); i++)
+            {
+                size_t l1 = mnet->layers()->index_of(layers[i]);
+                double size1 = structures == "actors" ? layers[i]->vertices()->size() : layers[i]->edges()->size();
+
+                // sizes are exact, the intersection is estimated from the Jaccard similarity
+                double jaccard = estimate_jaccard(sketches[l1], sketches[l2]);
+                double a = std::isnan(jaccard) ? 0 : jaccard * (size1 + size2) / (1 + jaccard);
+                a = std::min(a, std::min(size1, size2));
+                double b = size1 - a;
+                double c = size2 - a;
+                double d = std::max(0.0, num_structures - a - b - c);
+                values[j][i] = overlap_similarity(function, a, b, c, d);
+            }
+        }
+    }
+
+    else if (method=="jaccard.actors")
     {
         uu::core::PropertyMatrix<const uu::net::Vertex*, const uu::net::Network*,bool> P = uu::net::actor_existence_property_matrix(mnet);
 
@@ -2739,80 +3029,41 @@ comparison_ml(
         }
     }
 
-    else if (method=="jaccard.triangles")
-    {
-        uu::core::PropertyMatrix<uu::net::Triad, const uu::net::Network*,bool> P = uu::net::triangle_existence_property_matrix(mnet);
-
-        for (size_t j=0; j<layers.size(); j++)
-        {
-            for (size_t i=0; i<layers.size(); i++)
-            {
-                values[j][i] = uu::core::jaccard<uu::net::Triad, const uu::net::Network*>(P,layers[i],layers[j]);
-            }
-        }
-    }
-
-    else if (method=="coverage.triangles")
+    else if (method=="jaccard.triangles" || method=="coverage.triangles" ||
+             method=="kulczynski2.triangles" || method=="sm.triangles" ||
+             method=="rr.triangles" || method=="hamann.triangles")
     {
-        uu::core::PropertyMatrix<uu::net::Triad, const uu::net::Network*,bool> P = uu::net::triangle_existence_property_matrix(mnet);
-
-        for (size_t j=0; j<layers.size(); j++)
-        {
-            for (size_t i=0; i<layers.size(); i++)
-            {
-                values[j][i] = uu::core::coverage<uu::net::Triad, const uu::net::Network*>(P,layers[i],layers[j]);
-            }
-        }
-    }
+        size_t num_threads = resolve_num_threads(threads);
+        auto idx = build_ml_index(mnet, num_threads);
 
-    else if (method=="kulczynski2.triangles")
-    {
-        uu::core::PropertyMatrix<uu::net::Triad, const uu::net::Network*,bool> P = uu::net::triangle_existence_property_matrix(mnet);
+        std::vector<LayerTriangles> triangles;
+        std::vector<const std::vector<TriadKey>*> triads;
 
-        for (size_t j=0; j<layers.size(); j++)
+        for (auto& layer: idx.layers)
         {
-            for (size_t i=0; i<layers.size(); i++)
-            {
-                values[j][i] = uu::core::kulczynski2<uu::net::Triad, const uu::net::Network*>(P,layers[i],layers[j]);
-            }
+            triangles.push_back(find_triangles(layer, num_threads, true));
         }
-    }
 
-    else if (method=="sm.triangles")
-    {
-        uu::core::PropertyMatrix<uu::net::Triad, const uu::net::Network*,bool> P = uu::net::triangle_existence_property_matrix(mnet);
-
-        for (size_t j=0; j<layers.size(); j++)
+        for (auto& t: triangles)
         {
-            for (size_t i=0; i<layers.size(); i++)
-            {
-                values[j][i] = uu::core::simple_matching<uu::net::Triad, const uu::net::Network*>(P,layers[i],layers[j]);
-            }
+            triads.push_back(&t.triads);
         }
-    }
 
-    else if (method=="rr.triangles")
-    {
-        uu::core::PropertyMatrix<uu::net::Triad, const uu::net::Network*,bool> P = uu::net::triangle_existence_property_matrix(mnet);
+        // triangles present on at least one layer of the network
+        double num_structures = count_distinct_triads(triads);
+        std::string function = method.substr(0, method.find('.'));
 
         for (size_t j=0; j<layers.size(); j++)
         {
-            for (size_t i=0; i<layers.size(); i++)
-            {
-                values[j][i] = uu::core::russell_rao<uu::net::Triad, const uu::net::Network*>(P,layers[i],layers[j]);
-            }
-        }
-    }
-
-    else if (method=="hamann.triangles")
-    {
-        uu::core::PropertyMatrix<uu::net::Triad, const uu::net::Network*,bool> P = uu::net::triangle_existence_property_matrix(mnet);
+            auto& t2 = triangles.at(mnet->layers()->index_of(layers[j])).triads;
 
-        for (size_t j=0; j<layers.size(); j++)
-        {
             for (size_t i=0; i<layers.size(); i++)
             {
-                values[j][i] = uu::core::hamann<uu::net::Triad, const uu::net::Network*>(P,layers[i],layers[j]);
+                auto& t1 = triangles.at(mnet->layers()->index_of(layers[i])).triads;
+                double a = count_common_triads(t1, t2);
+                double b = t1.size() - a;
+                double c = t2.size() - a;
+                values[j][i] = overlap_similarity(function, a, b, c, num_structures - a - b - c);
             }
         }
     }
@@ -3021,65 +3272,1196 @@ summary_ml(
 
 
 DataFrame
-distance_ml(
+triangles_ml(
     const RMLNetwork& rmnet,
-    const std::string& from_actor,
-    const CharacterVector& to_actors,
-    const std::string& method)
+    const CharacterVector& layer_names,
+    bool local,
+    int threads
+)
 {
-    // @todo DataFramce can be allocated from the beginning to increase efficiency
     auto mnet = rmnet.get_mlnet();
-    std::vector<const uu::net::Vertex*> actors_to = resolve_actors(mnet,to_actors);
-    auto actor_from = mnet->actors()->get(from_actor);
+    auto layers = resolve_layers(mnet, layer_names);
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
 
-    if (!actor_from)
+    if (!local)
     {
-        stop("no actor named " + from_actor);
+        CharacterVector layer_n(layers.size());
+        NumericVector count_n(layers.size());
+        NumericVector transitivity_n(layers.size());
+
+        for (size_t i=0; i<layers.size(); i++)
+        {
+            auto& li = idx.layers.at(mnet->layers()->index_of(layers[i]));
+            auto t = find_triangles(li, num_threads, false);
+            layer_n[i] = layers[i]->name;
+            count_n[i] = t.count;
+            transitivity_n[i] = transitivity(t);
+        }
+
+        return DataFrame::create(_["layer"] = layer_n, _["triangles"] = count_n, _["transitivity"] = transitivity_n);
     }
 
-    if (method=="multiplex")
+    size_t num_rows = 0;
+
+    for (auto layer: layers)
     {
-        auto dists = uu::net::pareto_distance(mnet, actor_from);
+        num_rows += layer->vertices()->size();
+    }
 
-        CharacterVector from, to;
-        std::vector<NumericVector> lengths;
+    CharacterVector actor_n(num_rows);
+    CharacterVector layer_n(num_rows);
+    NumericVector count_n(num_rows);
+    NumericVector cc_n(num_rows);
+
+    size_t row = 0;
+
+    for (auto layer: layers)
+    {
+        auto& li = idx.layers.at(mnet->layers()->index_of(layer));
+        auto t = find_triangles(li, num_threads, false);
+        auto cc = local_clustering(li, t);
 
-        for (size_t i=0; i<mnet->layers()->size(); i++)
+        for (size_t v=0; v<li.num_vertices(); v++)
         {
-            NumericVector v;
-            lengths.push_back(v);
+            actor_n[row] = idx.actors[li.actor[v]]->name;
+            layer_n[row] = layer->name;
+            count_n[row] = t.local[v];
+            cc_n[row] = cc[v];
+            row++;
         }
+    }
 
-        for (auto actor: actors_to)
-        {
-            for (auto d: dists[actor])
-            {
-                from.push_back(from_actor);
-                to.push_back(actor->name);
+    return DataFrame::create(_["actor"] = actor_n, _["layer"] = layer_n, _["triangles"] = count_n, _["cc"] = cc_n);
+}
 
-                for (size_t i=0; i<mnet->layers()->size(); i++)
-                {
-                    lengths[i].push_back(d.length(mnet->layers()->at(i)));
-                }
-            }
-        }
+
+DataFrame
+coreness_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto layers = resolve_const_layers(mnet, layer_names);
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    std::vector<size_t> offset;
+    size_t num_rows = 0;
+
+    for (auto layer: layers)
+    {
+        offset.push_back(num_rows);
+        num_rows += layer->vertices()->size();
+    }
+
+    CharacterVector actor_n(num_rows);
+    CharacterVector layer_n(num_rows);
+    IntegerVector coreness_n(num_rows);
+
+    std::vector<std::vector<size_t>> coreness(layers.size());
+
+    parallel_for(layers.size(), num_threads, [&](size_t i, size_t)
+    {
+        coreness[i] = layer_coreness(idx.layers[mnet->layers()->index_of(layers[i])]);
+    });
+
+    for (size_t i=0; i<layers.size(); i++)
+    {
+        auto& li = idx.layers[mnet->layers()->index_of(layers[i])];
+
+        for (size_t v=0; v<li.num_vertices(); v++)
+        {
+            actor_n[offset[i] + v] = idx.actors[li.actor[v]]->name;
+            layer_n[offset[i] + v] = layers[i]->name;
+            coreness_n[offset[i] + v] = coreness[i][v];
+        }
+    }
+
+    return DataFrame::create(_["actor"] = actor_n, _["layer"] = layer_n, _["coreness"] = coreness_n);
+}
+
+DataFrame
+cores_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto layers = resolve_const_layers(mnet, layer_names);
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    std::vector<size_t> layer_idx;
+
+    for (auto layer: layers)
+    {
+        layer_idx.push_back(mnet->layers()->index_of(layer));
+    }
+
+    auto g = core_graph(idx, layer_idx, num_threads);
+    auto cores = multilayer_cores(g, num_threads);
+
+    List res(layers.size() + 1);
+    CharacterVector names(layers.size() + 1);
+
+    for (size_t l=0; l<layers.size(); l++)
+    {
+        IntegerVector k_n(cores.k.size());
+
+        for (size_t i=0; i<cores.k.size(); i++)
+        {
+            k_n[i] = cores.k[i][l];
+        }
+
+        // prefixed, so that no layer name can collide with size
+        res[l] = k_n;
+        names[l] = "k." + layers[l]->name;
+    }
+
+    res[layers.size()] = IntegerVector(cores.size.begin(), cores.size.end());
+    names[layers.size()] = "size";
+    res.attr("names") = names;
+
+    return DataFrame(res);
+}
+
+RMLNetwork
+core_ml(
+    const RMLNetwork& rmnet,
+    const IntegerVector& k,
+    const CharacterVector& layer_names,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto layers = resolve_const_layers(mnet, layer_names);
+
+    if (k.size() != 1 && (size_t)k.size() != layers.size())
+    {
+        stop("k must contain one value, or one value for each layer");
+    }
+
+    std::vector<size_t> k_values;
+
+    for (size_t l=0; l<layers.size(); l++)
+    {
+        int value = k.size() == 1 ? k[0] : k[l];
+
+        if (value == NA_INTEGER || value < 0)
+        {
+            stop("k must contain non-negative integers");
+        }
+
+        k_values.push_back(value);
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    std::vector<size_t> layer_idx;
+
+    for (auto layer: layers)
+    {
+        layer_idx.push_back(mnet->layers()->index_of(layer));
+    }
+
+    auto g = core_graph(idx, layer_idx, num_threads);
+    std::vector<int> all(idx.num_actors());
+
+    for (size_t a=0; a<all.size(); a++)
+    {
+        all[a] = a;
+    }
+
+    auto core = multilayer_core(g, k_values, all);
+
+    // all the layers of the network, restricted to the actors in the core
+
+    auto res = std::make_shared<uu::net::MultilayerNetwork>(mnet->name);
+    std::unordered_map<const uu::net::Vertex*, const uu::net::Vertex*> actor_map;
+
+    for (auto a: core)
+    {
+        actor_map[idx.actors[a]] = res->actors()->add(idx.actors[a]->name);
+    }
+
+    std::vector<uu::net::Network*> new_layers;
+
+    for (auto layer: *mnet->layers())
+    {
+        auto dir = layer->is_directed() ? uu::net::EdgeDir::DIRECTED : uu::net::EdgeDir::UNDIRECTED;
+        auto new_layer = res->layers()->add(layer->name, dir, uu::net::LoopMode::ALLOWED);
+        new_layers.push_back(new_layer);
+
+        for (auto actor: *layer->vertices())
+        {
+            auto a = actor_map.find(actor);
+
+            if (a != actor_map.end())
+            {
+                new_layer->vertices()->add(a->second);
+            }
+        }
+
+        for (auto edge: *layer->edges())
+        {
+            auto a1 = actor_map.find(edge->v1);
+            auto a2 = actor_map.find(edge->v2);
+
+            if (a1 != actor_map.end() && a2 != actor_map.end())
+            {
+                new_layer->edges()->add(a1->second, a2->second);
+            }
+        }
+    }
+
+    size_t L = new_layers.size();
+
+    for (size_t i=0; i<L; i++)
+    {
+        for (size_t j=0; j<L; j++)
+        {
+            auto l1 = mnet->layers()->at(i);
+            auto l2 = mnet->layers()->at(j);
+
+            if (l2 <= l1)
+            {
+                continue;
+            }
+
+            auto edges = mnet->interlayer_edges()->get(l1, l2);
+
+            if (!edges)
+            {
+                continue;
+            }
+
+            auto dir = mnet->interlayer_edges()->is_directed(l1, l2) ? uu::net::EdgeDir::DIRECTED : uu::net::EdgeDir::UNDIRECTED;
+            res->interlayer_edges()->init(new_layers[i], new_layers[j], dir);
+
+            for (auto edge: *edges)
+            {
+                auto a1 = actor_map.find(edge->v1);
+                auto a2 = actor_map.find(edge->v2);
+
+                if (a1 != actor_map.end() && a2 != actor_map.end())
+                {
+                    res->interlayer_edges()->add(a1->second, new_layers[i], a2->second, new_layers[j]);
+                }
+            }
+        }
+    }
+
+    return RMLNetwork(res);
+}
+
+DataFrame
+components_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    const std::string& mode,
+    const std::string& graph,
+    bool isolated,
+    bool sizes,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto layers = resolve_const_layers(mnet, layer_names);
+
+    if (mode != "weak" && mode != "strong")
+    {
+        stop("Unexpected value: mode");
+    }
+
+    ComponentGraph g;
+
+    if (graph=="layers")
+    {
+        g = ComponentGraph::LAYERS;
+    }
+
+    else if (graph=="supra")
+    {
+        g = ComponentGraph::SUPRA;
+    }
+
+    else if (graph=="flat")
+    {
+        g = ComponentGraph::FLAT;
+    }
+
+    else
+    {
+        stop("Unexpected value: graph");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads, g != ComponentGraph::LAYERS);
+
+    std::vector<size_t> layer_idx;
+
+    for (auto layer: layers)
+    {
+        layer_idx.push_back(mnet->layers()->index_of(layer));
+    }
+
+    auto table = component_table(idx, layer_idx, g, mode=="strong", isolated, num_threads);
+
+    // name of each part in the layer column
+    std::vector<std::string> part_names;
+
+    if (g == ComponentGraph::LAYERS)
+    {
+        for (auto layer: layers)
+        {
+            part_names.push_back(layer->name);
+        }
+    }
+
+    else
+    {
+        part_names.push_back(g == ComponentGraph::SUPRA ? "_supra_" : "_flat_");
+    }
+
+    if (sizes)
+    {
+        // histogram of the component sizes of each part
+        std::vector<std::map<size_t, int>> hist(table.parts.size());
+        size_t num_rows = 0;
+
+        for (size_t p=0; p<table.parts.size(); p++)
+        {
+            for (auto size: table.parts[p].size)
+            {
+                hist[p][size]++;
+            }
+
+            num_rows += hist[p].size();
+        }
+
+        CharacterVector layer_n(num_rows);
+        IntegerVector size_n(num_rows);
+        IntegerVector count_n(num_rows);
+        size_t row = 0;
+
+        for (size_t p=0; p<hist.size(); p++)
+        {
+            for (auto& bin: hist[p])
+            {
+                layer_n[row] = part_names[p];
+                size_n[row] = bin.first;
+                count_n[row] = bin.second;
+                row++;
+            }
+        }
+
+        return DataFrame::create(_["layer"] = layer_n, _["size"] = size_n, _["count"] = count_n);
+    }
+
+    size_t num_rows = table.actor.size();
+    CharacterVector actor_n(num_rows);
+    CharacterVector layer_n(num_rows);
+    IntegerVector cid_n(num_rows);
+
+    for (size_t row=0; row<num_rows; row++)
+    {
+        actor_n[row] = idx.actors[table.actor[row]]->name;
+        layer_n[row] = table.layer[row] < 0 ? part_names[0] : idx.layers[table.layer[row]].layer->name;
+        cid_n[row] = table.cid[row];
+    }
+
+    return DataFrame::create(_["actor"] = actor_n, _["layer"] = layer_n, _["cid"] = cid_n);
+}
+
+DataFrame
+layer_stats_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    bool flat,
+    int samples,
+    double delta,
+    int seed,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto layers = resolve_const_layers(mnet, layer_names);
+
+    if (samples < 0)
+    {
+        stop("samples must be non-negative");
+    }
+
+    if (delta <= 0 || delta >= 1)
+    {
+        stop("delta must be between 0 and 1");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads, flat);
+
+    std::vector<size_t> layer_idx;
+
+    for (auto layer: layers)
+    {
+        layer_idx.push_back(mnet->layers()->index_of(layer));
+    }
+
+    // flattened network first, then the layers without their isolated vertices
+
+    std::vector<const LayerIndex*> graphs;
+    std::vector<bool> isolated;
+    std::vector<std::string> names;
+    std::vector<double> num_edges;
+    std::vector<bool> directed;
+    LayerIndex flat_index;
+
+    if (flat)
+    {
+        bool flat_directed = false;
+
+        for (auto layer: layers)
+        {
+            flat_directed = flat_directed || layer->is_directed();
+        }
+
+        for (auto l1: layers)
+        {
+            for (auto l2: layers)
+            {
+                if (l2 <= l1 || !mnet->interlayer_edges()->get(l1, l2))
+                {
+                    continue;
+                }
+
+                flat_directed = flat_directed || mnet->interlayer_edges()->is_directed(l1, l2);
+            }
+        }
+
+        // the flattening is a multigraph: in a directed flattening, undirected edges
+        // count as two edges
+        double m = 0;
+
+        for (auto layer: layers)
+        {
+            m += layer->edges()->size() * (flat_directed && !layer->is_directed() ? 2 : 1);
+        }
+
+        for (auto l1: layers)
+        {
+            for (auto l2: layers)
+            {
+                auto edges = mnet->interlayer_edges()->get(l1, l2);
+
+                if (l2 <= l1 || !edges)
+                {
+                    continue;
+                }
+
+                m += edges->size() * (flat_directed && !mnet->interlayer_edges()->is_directed(l1, l2) ? 2 : 1);
+            }
+        }
+
+        flat_index = flat_layer_index(idx, layer_idx, flat_directed);
+        graphs.push_back(&flat_index);
+        isolated.push_back(true);
+        names.push_back("_flat_");
+        num_edges.push_back(m);
+        directed.push_back(flat_directed);
+    }
+
+    for (size_t i=0; i<layers.size(); i++)
+    {
+        graphs.push_back(&idx.layers[layer_idx[i]]);
+        isolated.push_back(false);
+        names.push_back(layers[i]->name);
+        num_edges.push_back(layers[i]->edges()->size());
+        directed.push_back(layers[i]->is_directed());
+    }
+
+    auto stats = summarize_graphs(graphs, isolated, samples, delta, resolve_seed(seed), num_threads);
+
+    size_t num_rows = graphs.size();
+    NumericVector n_n(num_rows), m_n(num_rows), dir_n(num_rows), nc_n(num_rows), slc_n(num_rows);
+    NumericVector dens_n(num_rows), cc_n(num_rows), apl_n(num_rows), dia_n(num_rows), error_n(num_rows);
+    CharacterVector row_names(num_rows);
+
+    for (size_t i=0; i<num_rows; i++)
+    {
+        double n = stats[i].n;
+        n_n[i] = n;
+        m_n[i] = num_edges[i];
+        dir_n[i] = directed[i];
+        nc_n[i] = stats[i].nc;
+        slc_n[i] = stats[i].slc;
+        dens_n[i] = n < 2 ? std::numeric_limits<double>::quiet_NaN() : num_edges[i] / (n * (n - 1) / (directed[i] ? 1 : 2));
+        cc_n[i] = stats[i].cc;
+        apl_n[i] = stats[i].apl;
+        dia_n[i] = stats[i].dia;
+        error_n[i] = std::isnan(stats[i].apl_error) ? NA_REAL : stats[i].apl_error;
+        row_names[i] = names[i];
+    }
+
+    DataFrame res = DataFrame::create(_["n"] = n_n, _["m"] = m_n, _["dir"] = dir_n, _["nc"] = nc_n, _["slc"] = slc_n,
+                                      _["dens"] = dens_n, _["cc"] = cc_n, _["apl"] = apl_n, _["dia"] = dia_n);
+    res.attr("row.names") = row_names;
+
+    if (samples > 0)
+    {
+        res.attr("error") = error_n;
+    }
+
+    return res;
+}
+
+
+DataFrame
+distance_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& from_actors,
+    const CharacterVector& to_actors,
+    const std::string& method,
+    int max_length,
+    int threads)
+{
+    auto mnet = rmnet.get_mlnet();
+    std::vector<const uu::net::Vertex*> actors_from;
+
+    for (int i=0; i<from_actors.size(); i++)
+    {
+        auto actor = mnet->actors()->get(std::string(from_actors[i]));
+
+        if (!actor)
+        {
+            stop("no actor named " + std::string(from_actors[i]));
+        }
+
+        actors_from.push_back(actor);
+    }
+
+    std::vector<const uu::net::Vertex*> actors_to = resolve_actors(mnet,to_actors);
+
+    if (max_length < 0)
+    {
+        stop("max.length must be non-negative");
+    }
+
+    if (method=="multiplex")
+    {
+        size_t num_threads = resolve_num_threads(threads);
+        auto idx = build_ml_index(mnet, num_threads);
+
+        std::unordered_map<const uu::net::Vertex*, int> actor_pos;
+
+        for (size_t a=0; a<idx.num_actors(); a++)
+        {
+            actor_pos[idx.actors[a]] = a;
+        }
+
+        std::vector<int> sources;
+
+        for (auto actor: actors_from)
+        {
+            sources.push_back(actor_pos.at(actor));
+        }
+
+        // no targets: all actors, in the same order as resolve_actors
+        std::vector<int> targets;
+
+        if (to_actors.size() > 0)
+        {
+            for (auto actor: actors_to)
+            {
+                targets.push_back(actor_pos.at(actor));
+            }
+        }
+
+        auto dists = pareto_distances(idx, sources, targets, max_length, num_threads);
+
+        size_t num_rows = 0;
+
+        for (auto& d: dists)
+        {
+            num_rows += d.size();
+        }
+
+        size_t num_layers = idx.num_layers();
+        CharacterVector from(num_rows), to(num_rows);
+        std::vector<NumericVector> lengths;
+
+        for (size_t l=0; l<num_layers; l++)
+        {
+            lengths.push_back(NumericVector(num_rows));
+        }
+
+        size_t row = 0;
+
+        for (size_t s=0; s<dists.size(); s++)
+        {
+            auto& d = dists[s];
+
+            for (size_t i=0; i<d.size(); i++)
+            {
+                from[row] = actors_from[s]->name;
+                to[row] = idx.actors[d.target[i]]->name;
+
+                for (size_t l=0; l<num_layers; l++)
+                {
+                    lengths[l][row] = d.lengths[i*num_layers+l];
+                }
+
+                row++;
+            }
+        }
 
         DataFrame res = DataFrame::create(_["from"] = from, _["to"] = to);
 
-        for (size_t i=0; i<mnet->layers()->size(); i++)
+        for (size_t l=0; l<num_layers; l++)
+        {
+            res.push_back(lengths[l],idx.layers[l].layer->name);
+        }
+
+        return DataFrame(res);
+    }
+
+    else
+    {
+        stop("Unexpected value: method");
+    }
+
+    return 0;
+}
+
+SEXP
+distance_matrix_ml(
+    const RMLNetwork& rmnet,
+    const std::string& method,
+    int max_length,
+    const std::string& file,
+    double memory_limit,
+    int threads,
+    bool progress)
+{
+    auto mnet = rmnet.get_mlnet();
+
+    if (method!="multiplex")
+    {
+        stop("Unexpected value: method");
+    }
+
+    if (max_length < 0)
+    {
+        stop("max.length must be non-negative");
+    }
+
+    if (memory_limit <= 0)
+    {
+        stop("memory.limit must be positive");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    size_t num_actors = idx.num_actors();
+    size_t num_layers = idx.num_layers();
+    double max_bytes = memory_limit * 1024 * 1024;
+
+    std::vector<int> sources(num_actors);
+
+    for (size_t a=0; a<num_actors; a++)
+    {
+        sources[a] = a;
+    }
+
+    auto report = [&](size_t done)
+    {
+        checkUserInterrupt();
+
+        if (progress)
+        {
+            Rcout << "\rprocessed " << done << " of " << num_actors << " actors" << std::flush;
+
+            if (done == num_actors)
+            {
+                Rcout << std::endl;
+            }
+        }
+    };
+
+    // results streamed to file: rows of 32-bit integers (from, to, length on each layer)
+
+    std::ofstream out;
+    std::string path = file;
+    double num_rows = 0;
+    std::vector<int32_t> buffer;
+
+    auto open = [&]()
+    {
+        out.open(path, std::ios::binary);
+
+        if (!out)
         {
-            res.push_back(lengths[i],mnet->layers()->at(i)->name);
+            stop("cannot open file " + path);
         }
+    };
 
-        return DataFrame(res);
+    auto write = [&]()
+    {
+        out.write((const char*)buffer.data(), buffer.size() * sizeof(int32_t));
+        num_rows += buffer.size() / (2 + num_layers);
+        buffer.clear();
+
+        if (!out)
+        {
+            stop("cannot write to file " + path);
+        }
+    };
+
+    auto stream = [&](size_t first, const std::vector<ParetoDistances>& block)
+    {
+        for (size_t s=0; s<block.size(); s++)
+        {
+            auto& d = block[s];
+
+            for (size_t i=0; i<d.size(); i++)
+            {
+                buffer.push_back(first + s + 1);
+                buffer.push_back(d.target[i] + 1);
+                buffer.insert(buffer.end(), d.lengths.begin() + i*num_layers, d.lengths.begin() + (i+1)*num_layers);
+            }
+
+            write();
+        }
+
+        report(first + block.size());
+    };
+
+    // without file, results exceeding memory.limit are spilled to a temporary file,
+    // returned as if it had been passed as file
+    auto spill = [&]()
+    {
+        path = as<std::string>(Function("tempfile")(_["fileext"] = ".bin"));
+        Rcout << "distances exceeding memory.limit: writing them to " << path << std::endl;
+        open();
+    };
+
+    auto written = [&]()
+    {
+        out.close();
+        NumericVector res(1, num_rows);
+
+        if (file == "")
+        {
+            res.attr("file") = path;
+        }
+
+        return res;
+    };
+
+    if (file != "")
+    {
+        open();
+        pareto_distances_by_block(idx, sources, std::vector<int>(), max_length, num_threads, max_bytes, stream);
+        return written();
+    }
+
+    CharacterVector actor_names(num_actors);
+
+    for (size_t a=0; a<num_actors; a++)
+    {
+        actor_names[a] = idx.actors[a]->name;
+    }
+
+    // one layer: at most one distance for each pair, returned as a matrix
+
+    if (num_layers == 1)
+    {
+        double matrix_bytes = (double)num_actors * num_actors * sizeof(int);
+
+        if (matrix_bytes > max_bytes)
+        {
+            spill();
+            pareto_distances_by_block(idx, sources, std::vector<int>(), max_length, num_threads, max_bytes, stream);
+            return written();
+        }
+
+        IntegerMatrix res(num_actors, num_actors);
+        std::fill(res.begin(), res.end(), NA_INTEGER);
+
+        pareto_distances_by_block(idx, sources, std::vector<int>(), max_length, num_threads, max_bytes - matrix_bytes,
+                                  [&](size_t first, const std::vector<ParetoDistances>& block)
+        {
+            for (size_t s=0; s<block.size(); s++)
+            {
+                auto& d = block[s];
+
+                for (size_t i=0; i<d.size(); i++)
+                {
+                    res(first + s, d.target[i]) = d.lengths[i];
+                }
+            }
+
+            report(first + block.size());
+        });
+
+        res.attr("dimnames") = List::create(actor_names, actor_names);
+        return res;
+    }
+
+    // columnar data frame, with from and to stored as factors; the searches use a quarter
+    // of the budget and the columns the rest, as the data frame is a second copy of them
+
+    std::vector<int> from, to;
+    std::vector<std::vector<int>> lengths(num_layers);
+    size_t row_bytes = (2 + num_layers) * sizeof(int);
+
+    pareto_distances_by_block(idx, sources, std::vector<int>(), max_length, num_threads, max_bytes / 4,
+                              [&](size_t first, const std::vector<ParetoDistances>& block)
+    {
+        if (out.is_open())
+        {
+            stream(first, block);
+            return;
+        }
+
+        size_t block_rows = 0;
+
+        for (auto& d: block)
+        {
+            block_rows += d.size();
+        }
+
+        if (2.0 * (from.size() + block_rows) * row_bytes > 0.75 * max_bytes)
+        {
+            // the rows kept so far are written first, preserving the order of the sources
+            spill();
+
+            for (size_t r=0; r<from.size(); r++)
+            {
+                buffer.push_back(from[r]);
+                buffer.push_back(to[r]);
+
+                for (size_t l=0; l<num_layers; l++)
+                {
+                    buffer.push_back(lengths[l][r]);
+                }
+
+                if (buffer.size() >= (1 << 16))
+                {
+                    write();
+                }
+            }
+
+            write();
+            std::vector<int>().swap(from);
+            std::vector<int>().swap(to);
+
+            for (auto& column: lengths)
+            {
+                std::vector<int>().swap(column);
+            }
+
+            stream(first, block);
+            return;
+        }
+
+        for (size_t s=0; s<block.size(); s++)
+        {
+            auto& d = block[s];
+
+            for (size_t i=0; i<d.size(); i++)
+            {
+                from.push_back(first + s + 1);
+                to.push_back(d.target[i] + 1);
+
+                for (size_t l=0; l<num_layers; l++)
+                {
+                    lengths[l].push_back(d.lengths[i*num_layers+l]);
+                }
+            }
+        }
+
+        report(first + block.size());
+    });
+
+    if (out.is_open())
+    {
+        return written();
+    }
+
+    IntegerVector from_col(from.begin(), from.end());
+    IntegerVector to_col(to.begin(), to.end());
+    from_col.attr("levels") = actor_names;
+    from_col.attr("class") = "factor";
+    to_col.attr("levels") = actor_names;
+    to_col.attr("class") = "factor";
+
+    DataFrame res = DataFrame::create(_["from"] = from_col, _["to"] = to_col);
+
+    for (size_t l=0; l<num_layers; l++)
+    {
+        res.push_back(IntegerVector(lengths[l].begin(), lengths[l].end()), idx.layers[l].layer->name);
+        std::vector<int>().swap(lengths[l]);
+    }
+
+    return DataFrame(res);
+}
+
+NumericVector
+betweenness_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& actor_names,
+    const CharacterVector& layer_names,
+    const std::string& type,
+    int samples,
+    double delta,
+    int seed,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto actors = resolve_actors(mnet,actor_names);
+    auto layers = resolve_const_layers(mnet,layer_names);
+    auto mode = resolve_mode(type);
+
+    if (samples < 0)
+    {
+        stop("samples must be non-negative");
+    }
+
+    if (delta <= 0 || delta >= 1)
+    {
+        stop("delta must be between 0 and 1");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    std::vector<size_t> layer_idx;
+
+    for (auto layer: layers)
+    {
+        layer_idx.push_back(mnet->layers()->index_of(layer));
+    }
+
+    bool undirected = mode == uu::net::EdgeMode::INOUT;
+    auto g = actor_graph(idx, layer_idx, true, undirected);
+    double n = g.present.size();
+
+    // each undirected path is found from both its ends
+    double scale = undirected ? .5 : 1;
+    std::vector<double> sums;
+
+    if (samples == 0)
+    {
+        sums = dependency_sums(g, g.present, num_threads);
     }
 
     else
     {
-        stop("Unexpected value: method");
+        auto pivots = sample_pivots(g, samples, resolve_seed(seed));
+        sums = dependency_sums(g, pivots, num_threads);
+        scale *= n / samples;
     }
 
-    return 0;
+    std::unordered_map<const uu::net::Vertex*, int> actor_pos;
+
+    for (size_t a=0; a<idx.num_actors(); a++)
+    {
+        actor_pos[idx.actors[a]] = a;
+    }
+
+    std::vector<bool> is_present(idx.num_actors(), false);
+
+    for (auto a: g.present)
+    {
+        is_present[a] = true;
+    }
+
+    NumericVector res(actors.size());
+
+    for (size_t i=0; i<actors.size(); i++)
+    {
+        int a = actor_pos.at(actors[i]);
+        res[i] = is_present[a] ? sums[a] * scale : NA_REAL;
+    }
+
+    if (samples > 0)
+    {
+        // dependencies are in [0, n-2]
+        double bound = n * (n - 2) * sampling_error(samples, n, delta);
+        res.attr("error") = undirected ? bound / 2 : bound;
+    }
+
+    return res;
+}
+
+NumericVector
+closeness_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& actor_names,
+    const CharacterVector& layer_names,
+    const std::string& type,
+    int samples,
+    double delta,
+    int seed,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto actors = resolve_actors(mnet,actor_names);
+    auto layers = resolve_const_layers(mnet,layer_names);
+    auto mode = resolve_mode(type);
+
+    if (samples < 0)
+    {
+        stop("samples must be non-negative");
+    }
+
+    if (delta <= 0 || delta >= 1)
+    {
+        stop("delta must be between 0 and 1");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    std::vector<size_t> layer_idx;
+
+    for (auto layer: layers)
+    {
+        layer_idx.push_back(mnet->layers()->index_of(layer));
+    }
+
+    // distances to the pivots are computed on the reversed view
+    auto rg = actor_graph(idx, layer_idx, mode != uu::net::EdgeMode::OUT, mode != uu::net::EdgeMode::IN);
+    double n = rg.present.size();
+    double scale = n > 1 ? 1 / (n - 1) : 0;
+    std::vector<double> sums;
+
+    if (samples == 0)
+    {
+        sums = inverse_distance_sums(rg, rg.present, num_threads);
+    }
+
+    else
+    {
+        auto pivots = sample_pivots(rg, samples, resolve_seed(seed));
+        sums = inverse_distance_sums(rg, pivots, num_threads);
+        scale *= n / samples;
+    }
+
+    std::unordered_map<const uu::net::Vertex*, int> actor_pos;
+
+    for (size_t a=0; a<idx.num_actors(); a++)
+    {
+        actor_pos[idx.actors[a]] = a;
+    }
+
+    std::vector<bool> is_present(idx.num_actors(), false);
+
+    for (auto a: rg.present)
+    {
+        is_present[a] = true;
+    }
+
+    NumericVector res(actors.size());
+
+    for (size_t i=0; i<actors.size(); i++)
+    {
+        int a = actor_pos.at(actors[i]);
+        res[i] = is_present[a] ? sums[a] * scale : NA_REAL;
+    }
+
+    if (samples > 0)
+    {
+        // each sampled term n/(n-1) * 1/d is in [0, n/(n-1)]
+        res.attr("error") = (n > 1 ? n / (n - 1) : 0) * sampling_error(samples, n, delta);
+    }
+
+    return res;
+}
+
+IntegerMatrix
+random_walks_ml(
+    const RMLNetwork& rmnet,
+    int length,
+    int walks,
+    const CharacterVector& actor_names,
+    const NumericMatrix& switching,
+    const std::string& weight,
+    bool interlayer,
+    int seed,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+
+    if (length < 0 || walks < 0)
+    {
+        stop("length and walks must be non-negative");
+    }
+
+    size_t num_layers = mnet->layers()->size();
+    std::vector<double> s;
+
+    if (switching.nrow() > 0 || switching.ncol() > 0)
+    {
+        if ((size_t)switching.nrow() != num_layers || (size_t)switching.ncol() != num_layers)
+        {
+            stop("dimensions of the switching matrix do not match the number of layers in the network");
+        }
+
+        for (size_t i=0; i<num_layers; i++)
+        {
+            for (size_t j=0; j<num_layers; j++)
+            {
+                s.push_back(switching(i,j));
+            }
+        }
+    }
+
+    auto actors = resolve_actors_unordered(mnet,actor_names);
+
+    // start vertices, in the order of vertices_ml()
+    std::vector<int> starts;
+    int v = 0;
+
+    for (auto layer: *mnet->layers())
+    {
+        for (auto actor: *layer->vertices())
+        {
+            if (actors.count(actor) > 0)
+            {
+                starts.push_back(v);
+            }
+
+            v++;
+        }
+    }
+
+    if ((double)starts.size() * walks > std::numeric_limits<int>::max())
+    {
+        stop("too many walks");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    uint64_t walk_seed = resolve_seed(seed);
+    auto g = build_walk_graph(mnet, weight, interlayer, s, num_threads);
+
+    IntegerMatrix res(starts.size() * walks, length + 1);
+    random_walks(g, starts, walks, length, walk_seed, num_threads, res.begin());
+
+    for (auto& x: res)
+    {
+        x = (x < 0) ? NA_INTEGER : x + 1;
+    }
+
+    return res;
 }
 
 /*
@@ -3106,34 +4488,143 @@ return res;
 } ///////
 */
 
-// COMMUNITY DETECTION
+// COMMUNITY DETECTION
+
+DataFrame
+cliquepercolation_ml(
+    const RMLNetwork& rmnet,
+    int k,
+    int m,
+    int threads,
+    bool compact
+)
+{
+    auto mnet = rmnet.get_mlnet();
+
+    if (k < 3)
+    {
+        stop("k must be at least 3");
+    }
+
+    if (m < 1)
+    {
+        stop("m must be at least 1");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    auto communities = clique_percolation(idx, k, m, num_threads);
+    return compact ? to_compact(idx, communities) : to_dataframe(idx, communities);
+}
+
 
 DataFrame
-cliquepercolation_ml(
+glouvain_ml(
     const RMLNetwork& rmnet,
-    int k,
-    int m
+    double gamma,
+    double omega,
+    const std::string& coupling,
+    bool deterministic,
+    const DataFrame& initial,
+    int threads,
+    bool compact
 )
 {
     auto mnet = rmnet.get_mlnet();
 
-    auto com_struct = mlcpm(mnet, k, m);
-    return to_dataframe(com_struct.get());
-}
+    if (gamma < 0)
+    {
+        stop("gamma must be non-negative");
+    }
+
+    if (omega < 0)
+    {
+        stop("omega must be non-negative");
+    }
 
+    Coupling c = resolve_coupling(coupling);
 
-DataFrame
-glouvain_ml(
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    // warm start from the input communities, if any
+    std::vector<int> membership;
+
+    if (initial.size() > 0)
+    {
+        membership = to_membership(initial, idx, mnet);
+    }
+
+    GeneralizedLouvain louvain(idx, c, num_threads);
+    auto partition = louvain.run(gamma, omega, deterministic, membership, num_threads);
+
+    return compact ? to_compact(idx, partition.membership, partition.num_communities) :
+           to_dataframe(idx, partition.membership, partition.num_communities);
+}
+
+List
+glouvain_sweep_ml(
     const RMLNetwork& rmnet,
-    double gamma,
-    double omega
+    const NumericVector& gammas,
+    const NumericVector& omegas,
+    const std::string& coupling,
+    bool deterministic,
+    bool warm_start,
+    int threads,
+    bool compact
 )
 {
     auto mnet = rmnet.get_mlnet();
 
-    auto com_struct = uu::net::glouvain2<M>(mnet, omega, gamma);
+    if (gammas.size() == 0 || omegas.size() == 0)
+    {
+        stop("gammas and omegas cannot be empty");
+    }
 
-    return to_dataframe(com_struct.get());
+    for (auto gamma: gammas)
+    {
+        if (!(gamma >= 0))
+        {
+            stop("gamma must be non-negative");
+        }
+    }
+
+    for (auto omega: omegas)
+    {
+        if (!(omega >= 0))
+        {
+            stop("omega must be non-negative");
+        }
+    }
+
+    Coupling c = resolve_coupling(coupling);
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    std::vector<double> g(gammas.begin(), gammas.end());
+    std::vector<double> o(omegas.begin(), omegas.end());
+    auto partitions = generalized_louvain_sweep(idx, g, o, c, deterministic, warm_start, num_threads);
+
+    size_t num_points = partitions.size();
+    NumericVector gamma_n(num_points), omega_n(num_points), modularity_n(num_points);
+    IntegerVector num_communities_n(num_points);
+    List communities(num_points);
+
+    for (size_t i=0; i<num_points; i++)
+    {
+        gamma_n[i] = g[i / o.size()];
+        omega_n[i] = o[i % o.size()];
+        modularity_n[i] = partitions[i].modularity;
+        num_communities_n[i] = partitions[i].num_communities;
+        communities[i] = compact ?
+                         to_compact(idx, partitions[i].membership, partitions[i].num_communities) :
+                         to_dataframe(idx, partitions[i].membership, partitions[i].num_communities);
+    }
+
+    DataFrame grid = DataFrame::create(_["gamma"] = gamma_n, _["omega"] = omega_n, _["modularity"] = modularity_n,
+                                       _["num.communities"] = num_communities_n);
+
+    return List::create(_["grid"] = grid, _["communities"] = communities);
 }
 
 
@@ -3154,45 +4645,232 @@ DataFrame
 abacus_ml(
     const RMLNetwork& rmnet,
     int min_actors,
-    int min_layers
+    int min_layers,
+    int max_itemsets,
+    double max_time,
+    int threads,
+    bool compact
 )
 {
     auto mnet = rmnet.get_mlnet();
-    auto com_struct = uu::net::abacus(mnet, min_actors, min_layers);
-    return to_dataframe(com_struct.get());
+
+    if (min_actors < 1)
+    {
+        stop("min.actors must be at least 1");
+    }
+
+    if (min_layers < 1)
+    {
+        stop("min.layers must be at least 1");
+    }
+
+    if (max_itemsets < 0 || max_time < 0)
+    {
+        stop("max.itemsets and max.time cannot be negative");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    MiningBudget budget;
+    budget.max_itemsets = max_itemsets;
+    budget.max_seconds = max_time;
+
+    auto res = abacus(idx, min_actors, min_layers, budget, num_threads);
+
+    if (!res.complete)
+    {
+        Rcout << "Warning: search stopped by max.itemsets or max.time, some communities may be missing" << std::endl;
+    }
+
+    return compact ? to_compact(idx, res.communities) : to_dataframe(idx, res.communities);
 }
 
+// flattening-based communities: each vertex is in the community of its actor
 DataFrame
-flat_ec(
-    const RMLNetwork& rmnet
+flat_communities(
+    const RMLNetwork& rmnet,
+    FlatWeight weight,
+    int threads,
+    bool compact
 )
 {
     auto mnet = rmnet.get_mlnet();
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
 
-    auto com_struct = uu::net::flat_ec(mnet);
-    return to_dataframe(com_struct.get());
+    auto partition = flat_louvain(idx, weight, num_threads);
+
+    std::vector<int> membership(idx.num_vertices);
+
+    for (auto& li: idx.layers)
+    {
+        for (size_t i=0; i<li.num_vertices(); i++)
+        {
+            membership[li.offset + i] = partition.membership[li.actor[i]];
+        }
+    }
+
+    return compact ? to_compact(idx, membership, partition.num_communities) :
+           to_dataframe(idx, membership, partition.num_communities);
+}
+
+DataFrame
+flat_ec(
+    const RMLNetwork& rmnet,
+    int threads,
+    bool compact
+)
+{
+    return flat_communities(rmnet, FlatWeight::EDGE_COUNT, threads, compact);
 }
 
 DataFrame
 flat_nw(
-    const RMLNetwork& rmnet
+    const RMLNetwork& rmnet,
+    int threads,
+    bool compact
+)
+{
+    return flat_communities(rmnet, FlatWeight::UNWEIGHTED, threads, compact);
+}
+
+DataFrame
+mdlp(
+     const RMLNetwork& rmnet,
+     const DataFrame& initial,
+     bool deterministic,
+     int seed,
+     int threads,
+     bool compact
 )
 {
     auto mnet = rmnet.get_mlnet();
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
 
-    auto com_struct = uu::net::flat_nw(mnet);
-    return to_dataframe(com_struct.get());
+    // initial label of each actor: the community of its first vertex
+    std::vector<int> labels;
+
+    if (initial.size() > 0)
+    {
+        auto membership = to_membership(initial, idx, mnet);
+        std::vector<int> id(membership.size(), -1);
+        labels.resize(idx.num_actors(), -1);
+        int next = 0;
+
+        for (size_t l=0; l<idx.num_layers(); l++)
+        {
+            auto& li = idx.layers[l];
+
+            for (size_t i=0; i<li.num_vertices(); i++)
+            {
+                int& c = id[membership[li.offset + i]];
+
+                if (labels[li.actor[i]] >= 0)
+                {
+                    continue;
+                }
+
+                if (c < 0)
+                {
+                    c = next++;
+                }
+
+                labels[li.actor[i]] = c;
+            }
+        }
+
+        for (auto& label: labels)
+        {
+            if (label < 0)
+            {
+                label = next++;
+            }
+        }
+    }
+
+    auto partition = label_propagation(idx, labels, deterministic, resolve_seed(seed), num_threads);
+
+    // each actor community contains the vertices of its actors
+    std::vector<int> membership(idx.num_vertices);
+
+    for (auto& li: idx.layers)
+    {
+        for (size_t i=0; i<li.num_vertices(); i++)
+        {
+            membership[li.offset + i] = partition.membership[li.actor[i]];
+        }
+    }
+
+    return compact ? to_compact(idx, membership, partition.num_communities) :
+           to_dataframe(idx, membership, partition.num_communities);
 }
 
 DataFrame
-mdlp(
-     const RMLNetwork& rmnet
+consensus_ml(
+    const RMLNetwork& rmnet,
+    const std::string& algorithm,
+    int runs,
+    double threshold,
+    double gamma,
+    double omega,
+    int seed,
+    int threads,
+    bool compact
 )
 {
     auto mnet = rmnet.get_mlnet();
 
-    auto com_struct = uu::net::mlp(mnet);
-    return to_dataframe(com_struct.get());
+    ConsensusAlgorithm a;
+
+    if (algorithm=="glouvain")
+    {
+        a = ConsensusAlgorithm::GLOUVAIN;
+    }
+
+    else if (algorithm=="mdlp")
+    {
+        a = ConsensusAlgorithm::MDLP;
+    }
+
+    else
+    {
+        stop("Unexpected value: algorithm");
+    }
+
+    if (runs < 1)
+    {
+        stop("runs must be positive");
+    }
+
+    if (!(threshold > 0 && threshold <= 1))
+    {
+        stop("threshold must be in (0, 1]");
+    }
+
+    if (gamma < 0)
+    {
+        stop("gamma must be non-negative");
+    }
+
+    if (omega < 0)
+    {
+        stop("omega must be non-negative");
+    }
+
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+
+    auto partition = consensus(idx, a, runs, threshold, gamma, omega, resolve_seed(seed), num_threads);
+
+    if (!partition.converged)
+    {
+        Rcout << "Warning: the runs did not agree after the maximum number of rounds, communities are the components of the last consensus graph" << std::endl;
+    }
+
+    return compact ? to_compact(idx, partition.membership, partition.num_communities) :
+           to_dataframe(idx, partition.membership, partition.num_communities);
 }
 
 /*
@@ -3211,46 +4889,157 @@ return to_dataframe(community_structure);
 
 double
 modularity_ml(
-              const RMLNetwork& rmnet,
-              const DataFrame& com,
-              double gamma,
-              double omega
-              )
+    const RMLNetwork& rmnet,
+    const DataFrame& com,
+    double gamma,
+    double omega,
+    int threads
+)
 {
     auto mnet = rmnet.get_mlnet();
-    auto communities = to_communities(com, mnet);
-    return uu::net::modularity(mnet, communities.get(), omega);
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    auto membership = to_membership(com, idx, mnet);
+
+    GeneralizedLouvain louvain(idx, Coupling::CATEGORICAL, num_threads);
+    return louvain.modularity(membership, gamma, omega, num_threads);
 }
 
+NumericVector
+modularity_delta_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com,
+    const DataFrame& moves,
+    double gamma,
+    double omega,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    std::unordered_map<long, int> ids;
+    auto membership = to_membership(com, idx, mnet, &ids);
+
+    auto vertex = to_vertices(moves, idx, mnet);
+    NumericVector moves_cid = moves["cid"];
+    std::vector<int> community(moves.nrow());
+
+    for (size_t i=0; i<moves.nrow(); i++)
+    {
+        // a community not in com is a new one
+        auto c = ids.find((long)moves_cid[i]);
+        community[i] = c == ids.end() ? -1 : c->second;
+    }
+
+    GeneralizedLouvain louvain(idx, Coupling::CATEGORICAL, num_threads);
+    auto delta = louvain.modularity_delta(membership, vertex, community, gamma, omega, num_threads);
+    return NumericVector(delta.begin(), delta.end());
+}
 
 double
 nmi(
     const RMLNetwork& rmnet,
     const DataFrame& com1,
-    const DataFrame& com2
+    const DataFrame& com2,
+    int threads
 )
 {
-    size_t num_vertices = numNodes(rmnet, CharacterVector());
     auto mnet = rmnet.get_mlnet();
-    auto c1 = to_communities(com1, mnet);
-    auto c2 = to_communities(com2, mnet);
-    return uu::net::nmi(c1.get(), c2.get(), num_vertices);
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    auto c1 = to_membership(com1, idx, mnet);
+    auto c2 = to_membership(com2, idx, mnet);
+    return normalized_mutual_information(c1, c2, num_threads);
 }
 
 double
 omega(
     const RMLNetwork& rmnet,
     const DataFrame& com1,
-    const DataFrame& com2
+    const DataFrame& com2,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    auto c1 = to_cover(com1, idx, mnet);
+    auto c2 = to_cover(com2, idx, mnet);
+    return omega_index(c1, c2, num_threads);
+}
+
+NumericVector
+compare_communities_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com,
+    const List& candidates,
+    const std::string& method,
+    int threads
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    size_t num_threads = resolve_num_threads(threads);
+    auto idx = build_ml_index(mnet, num_threads);
+    std::vector<double> res;
+
+    // the data frames are converted sequentially, then compared in parallel
+    if (method == "nmi")
+    {
+        auto reference = to_membership(com, idx, mnet);
+        std::vector<std::vector<int>> others;
+
+        for (size_t i=0; i<candidates.size(); i++)
+        {
+            others.push_back(to_membership(as<DataFrame>(candidates[i]), idx, mnet));
+        }
+
+        res = normalized_mutual_information(reference, others, num_threads);
+    }
+
+    else if (method == "omega")
+    {
+        auto reference = to_cover(com, idx, mnet);
+        std::vector<VertexCover> others;
+
+        for (size_t i=0; i<candidates.size(); i++)
+        {
+            others.push_back(to_cover(as<DataFrame>(candidates[i]), idx, mnet));
+        }
+
+        res = omega_index(reference, others, num_threads);
+    }
+
+    else
+    {
+        stop("unexpected value: method " + method);
+    }
+
+    return NumericVector(res.begin(), res.end());
+}
+
+
+DataFrame
+compact_communities_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com
 )
 {
-    size_t num_vertices = numNodes(rmnet, CharacterVector());
     auto mnet = rmnet.get_mlnet();
-    auto c1 = to_communities(com1, mnet);
-    auto c2 = to_communities(com2, mnet);
-    return uu::net::omega_index(c1.get(), c2.get(), num_vertices);
+    auto idx = build_vertex_index(mnet, 1);
+    return to_compact(com, idx, mnet);
 }
 
+DataFrame
+expand_communities_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com
+)
+{
+    auto mnet = rmnet.get_mlnet();
+    auto idx = build_vertex_index(mnet, 1);
+    return to_dataframe(com, idx, mnet);
+}
 
 List
 to_list(
@@ -3259,60 +5048,131 @@ to_list(
 )
 {
     auto mnet = rmnet.get_mlnet();
+    auto idx = build_vertex_index(mnet, 1);
+    auto vertices = to_vertices(cs, idx, mnet);
+    NumericVector cs_cid = cs["cid"];
+    size_t num_rows = vertices.size();
+    size_t num_layers = idx.num_layers();
 
-    // stores at which index vertices start in a layer
-    std::unordered_map<const G*, size_t> offset;
-    size_t num_vertices = 0;
+    // rank of each cid, in increasing order: cids are usually numbered from 0, so the
+    // ranks are computed by counting unless their range is larger than the number of rows
+    std::vector<int> cid(cs_cid.begin(), cs_cid.end());
+    std::vector<int> cids;
+    std::vector<int> rank(num_rows);
+    auto range = std::minmax_element(cid.begin(), cid.end());
 
-    for (auto layer: *mnet->layers())
+    if (num_rows > 0 && (size_t)((long)*range.second - *range.first) < num_rows)
     {
-        offset[layer] = num_vertices;
-        num_vertices += layer->vertices()->size();
-    }
+        int min = *range.first;
+        std::vector<int> dense(*range.second - min + 1, -1);
 
+        for (auto c: cid)
+        {
+            dense[c - min] = 0;
+        }
 
-    std::map<int, std::map<int, std::vector<int> > > list;
-    CharacterVector cs_actor = cs["actor"];
-    CharacterVector cs_layer = cs["layer"];
-    NumericVector cs_cid = cs["cid"];
+        for (size_t c=0; c<dense.size(); c++)
+        {
+            if (dense[c] == 0)
+            {
+                dense[c] = cids.size();
+                cids.push_back(c + min);
+            }
+        }
 
-    for (size_t i=0; i<cs.nrow(); i++)
+        for (size_t i=0; i<num_rows; i++)
+        {
+            rank[i] = dense[cid[i] - min];
+        }
+    }
+
+    else
     {
-        int comm_id = cs_cid[i];
-        auto layer = mnet->layers()->get(std::string(cs_layer[i]));
+        cids = cid;
+        std::sort(cids.begin(), cids.end());
+        cids.erase(std::unique(cids.begin(), cids.end()), cids.end());
 
-        if (!layer)
+        for (size_t i=0; i<num_rows; i++)
         {
-            stop("cannot find layer " + std::string(cs_layer[i]) + " (community structure not compatible with this network?)");
+            rank[i] = std::lower_bound(cids.begin(), cids.end(), cid[i]) - cids.begin();
         }
+    }
 
-        int l = mnet->layers()->index_of(layer);
-        auto actor = mnet->actors()->get(std::string(cs_actor[i]));
+    std::vector<int> layer(num_rows);
 
-        if (!actor)
+    for (size_t i=0; i<num_rows; i++)
+    {
+        layer[i] = idx.layer_of(vertices[i]);
+    }
+
+    // rows sorted by (cid, layer), keeping their order otherwise: stable counting sort by
+    // layer, then by cid
+    auto counting_sort = [&](const std::vector<int>& key, size_t num_keys, const std::vector<int>& in)
+    {
+        std::vector<size_t> start(num_keys + 1, 0);
+
+        for (auto i: in)
+        {
+            start[key[i] + 1]++;
+        }
+
+        for (size_t k=0; k<num_keys; k++)
         {
-            stop("cannot find actor " + std::string(cs_actor[i]) + " (community structure not compatible with this network?)");
+            start[k+1] += start[k];
         }
 
-        int vertex_idx = layer->vertices()->index_of(actor);
+        std::vector<int> out(in.size());
 
-        if (vertex_idx==-1)
+        for (auto i: in)
         {
-            stop("cannot find vertex " + std::string(cs_actor[i]) + "::" + std::string(cs_layer[i]) + " (community structure not compatible with this network?)");
+            out[start[key[i]]++] = i;
         }
 
-        int n = vertex_idx+offset[layer]+1;
-        list[comm_id][l].push_back(n);
+        return out;
+    };
+
+    std::vector<int> rows(num_rows);
+
+    for (size_t i=0; i<num_rows; i++)
+    {
+        rows[i] = i;
+    }
+
+    rows = counting_sort(layer, num_layers, rows);
+    rows = counting_sort(rank, cids.size(), rows);
+
+    // one element for each (cid, layer)
+    size_t num_groups = 0;
+
+    for (size_t p=0; p<num_rows; p++)
+    {
+        if (p == 0 || rank[rows[p]] != rank[rows[p-1]] || layer[rows[p]] != layer[rows[p-1]])
+        {
+            num_groups++;
+        }
     }
 
-    List res = List::create();
+    List res(num_groups);
+    size_t g = 0;
 
-    for (auto clist: list)
+    for (size_t p=0; p<num_rows; )
     {
-        for (auto llist: clist.second)
+        size_t q = p;
+
+        while (q < num_rows && rank[rows[q]] == rank[rows[p]] && layer[rows[q]] == layer[rows[p]])
+        {
+            q++;
+        }
+
+        IntegerVector aid(q - p);
+
+        for (size_t r=p; r<q; r++)
         {
-            res.push_back(List::create(_["cid"]=clist.first, _["lid"]=llist.first, _["aid"]=llist.second));
+            aid[r - p] = vertices[rows[r]] + 1;
         }
+
+        res[g++] = List::create(_["cid"]=cids[rank[rows[p]]], _["lid"]=layer[rows[p]], _["aid"]=aid);
+        p = q;
     }
 
     return res;
@@ -4,6 +4,7 @@
 #include <Rcpp.h>
 #include "networks/MultilayerNetwork.hpp"
 #include "generation/EvolutionModel.hpp"
+#include "live_stats.h"
 #include <unordered_set>
 #include <vector>
 #include <memory>
@@ -14,6 +15,7 @@ class RMLNetwork
 {
   private:
     std::shared_ptr<uu::net::MultilayerNetwork> ptr;
+    std::shared_ptr<LiveStats> stats;
 
   public:
 
@@ -35,6 +37,21 @@ class RMLNetwork
         return ptr.get();
     }
 
+    /** Incrementally maintained statistics, or nullptr if not enabled. */
+    LiveStats*
+    live_stats() const
+    {
+        return stats.get();
+    }
+
+    void
+    set_live_stats(
+        std::shared_ptr<LiveStats> s
+    )
+    {
+        stats = s;
+    }
+
 };
 
 class REvolutionModel
@@ -253,6 +270,13 @@ deleteEdges(
     const DataFrame& edges
 );
 
+void
+live_stats_ml(
+    RMLNetwork& rmnet,
+    bool enable,
+    bool neighbors
+);
+
 
 
 void
@@ -335,12 +359,15 @@ degree_deviation_ml(
 );
 
 
-/*
 NumericVector
 occupation_ml(
-    const RMLNetwork&, const NumericMatrix& transitions, double teleportation, long steps);
-
- */
+    const RMLNetwork&,
+    const NumericMatrix& transitions,
+    double teleportation,
+    double tol,
+    int max_iter,
+    int threads
+);
 
 NumericVector
 neighborhood_ml(
@@ -383,6 +410,16 @@ xrelevance_ml(
     const std::string& type
 );
 
+DataFrame
+top_actors_ml(
+    const RMLNetwork& rmnet,
+    const std::string& measure,
+    const CharacterVector& layer_names,
+    int k,
+    const std::string& type,
+    int threads
+);
+
 
 
 double
@@ -399,16 +436,119 @@ comparison_ml(
     const CharacterVector& layer_names,
     const std::string& method,
     const std::string& type,
-    int K
+    int K,
+    bool approx,
+    int sketch_size,
+    int threads
+);
+
+DataFrame
+triangles_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    bool local,
+    int threads
+);
+
+DataFrame
+coreness_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    int threads
+);
+
+DataFrame
+cores_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    int threads
+);
+
+RMLNetwork
+core_ml(
+    const RMLNetwork& rmnet,
+    const IntegerVector& k,
+    const CharacterVector& layer_names,
+    int threads
+);
+
+DataFrame
+components_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    const std::string& mode,
+    const std::string& graph,
+    bool isolated,
+    bool sizes,
+    int threads
+);
+
+DataFrame
+layer_stats_ml(
+    const RMLNetwork& rmnet,
+    const CharacterVector& layer_names,
+    bool flat,
+    int samples,
+    double delta,
+    int seed,
+    int threads
 );
 
 
 
 DataFrame
 distance_ml(const RMLNetwork& mnet,
-            const std::string& from,
+            const CharacterVector& from,
             const CharacterVector& to,
-            const std::string& method);
+            const std::string& method,
+            int max_length,
+            int threads);
+
+SEXP
+distance_matrix_ml(const RMLNetwork& mnet,
+                   const std::string& method,
+                   int max_length,
+                   const std::string& file,
+                   double memory_limit,
+                   int threads,
+                   bool progress);
+
+NumericVector
+betweenness_ml(
+    const RMLNetwork&,
+    const CharacterVector& actor_names,
+    const CharacterVector& layer_names,
+    const std::string& type,
+    int samples,
+    double delta,
+    int seed,
+    int threads
+);
+
+IntegerMatrix
+random_walks_ml(
+    const RMLNetwork&,
+    int length,
+    int walks,
+    const CharacterVector& actor_names,
+    const NumericMatrix& switching,
+    const std::string& weight,
+    bool interlayer,
+    int seed,
+    int threads
+);
+
+NumericVector
+closeness_ml(
+    const RMLNetwork&,
+    const CharacterVector& actor_names,
+    const CharacterVector& layer_names,
+    const std::string& type,
+    int samples,
+    double delta,
+    int seed,
+    int threads
+);
 
 // CLUSTERING
 
@@ -416,7 +556,9 @@ DataFrame
 cliquepercolation_ml(
     const RMLNetwork& rmnet,
     int k,
-    int m
+    int m,
+    int threads,
+    bool compact
 );
 
 
@@ -430,54 +572,132 @@ infomap_ml(
 
 DataFrame
 flat_ec(
-    const RMLNetwork& mnet
+    const RMLNetwork& mnet,
+    int threads,
+    bool compact
 );
 
 DataFrame
 flat_nw(
-    const RMLNetwork& mnet
+    const RMLNetwork& mnet,
+    int threads,
+    bool compact
 );
 
 DataFrame
 mdlp(
-     const RMLNetwork& mnet
+     const RMLNetwork& mnet,
+     const DataFrame& initial,
+     bool deterministic,
+     int seed,
+     int threads,
+     bool compact
+);
+
+DataFrame
+consensus_ml(
+    const RMLNetwork& rmnet,
+    const std::string& algorithm,
+    int runs,
+    double threshold,
+    double gamma,
+    double omega,
+    int seed,
+    int threads,
+    bool compact
 );
 
 DataFrame
 glouvain_ml(
     const RMLNetwork&,
     double gamma,
-    double omega
+    double omega,
+    const std::string& coupling,
+    bool deterministic,
+    const DataFrame& initial,
+    int threads,
+    bool compact
+);
+
+List
+glouvain_sweep_ml(
+    const RMLNetwork& rmnet,
+    const NumericVector& gammas,
+    const NumericVector& omegas,
+    const std::string& coupling,
+    bool deterministic,
+    bool warm_start,
+    int threads,
+    bool compact
 );
 
 DataFrame
 abacus_ml(
     const RMLNetwork&,
     int min_actors,
-    int min_layers
+    int min_layers,
+    int max_itemsets,
+    double max_time,
+    int threads,
+    bool compact
 );
 
 double
 modularity_ml(
     const RMLNetwork& rmnet,
-    const DataFrame& com, double gamma,
-    double omega
+    const DataFrame& com,
+    double gamma,
+    double omega,
+    int threads
+);
+
+NumericVector
+modularity_delta_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com,
+    const DataFrame& moves,
+    double gamma,
+    double omega,
+    int threads
 );
 
 double
 nmi(
     const RMLNetwork& rmnet,
     const DataFrame& com1,
-    const DataFrame& com2
+    const DataFrame& com2,
+    int threads
 );
 
 double
 omega(
     const RMLNetwork& rmnet,
     const DataFrame& com1,
-    const DataFrame& com2
+    const DataFrame& com2,
+    int threads
 );
 
+NumericVector
+compare_communities_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com,
+    const List& candidates,
+    const std::string& method,
+    int threads
+);
+
+
+DataFrame
+compact_communities_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com
+);
+
+DataFrame
+expand_communities_ml(
+    const RMLNetwork& rmnet,
+    const DataFrame& com
+);
 
 List
 to_list(
@@ -172,6 +172,7 @@ RCPP_MODULE(multinet)
 
 
     function("delete_edges_ml", &deleteEdges, List::create( _["n"], _["edges"]), "Deletes one or more edges from a multilayer network - each edge is a quadruple [actor,layer,actor,layer]");
+    function("live_stats_ml", &live_stats_ml, List::create( _["n"], _["enable"]=true, _["neighbors"]=false), "Enables or disables incrementally maintained degree and neighborhood statistics");
 
 
     // ATTRIBUTE HANDLING
@@ -194,22 +195,32 @@ RCPP_MODULE(multinet)
     function("degree_ml", &degree_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all"), "Returns the degree of each actor");
 
     function("degree_deviation_ml", &degree_deviation_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all"), "Returns the standard deviation of the degree of each actor on the specified layers");
-    /*
-    function("occupation_ml", &occupation_ml, List::create( _["n"], _["transitions"], _["teleportation"]=.2, _["steps"]=0), "Returns the occupation centrality value of each actor");
-     */
+    function("occupation_ml", &occupation_ml, List::create( _["n"], _["transitions"], _["teleportation"]=.2, _["tol"]=1e-10, _["max.iter"]=1000, _["threads"]=0), "Returns the occupation centrality value of each actor");
     function("neighborhood_ml", &neighborhood_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all"), "Returns the neighborhood of each actor");
     function("xneighborhood_ml", &xneighborhood_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all"), "Returns the exclusive neighborhood of each actor");
 
     function("connective_redundancy_ml", &connective_redundancy_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all"), "Returns the connective redundancy of each actor");
     function("relevance_ml", &relevance_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all"), "Returns the layer relevance of each actor");
     function("xrelevance_ml", &xrelevance_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all"), "Returns the exclusive layer relevance of each actor");
+    function("top_actors_ml", &top_actors_ml, List::create( _["n"], _["measure"]="degree", _["layers"]=CharacterVector(), _["k"]=10, _["mode"]="all", _["threads"]=0), "Returns the actors with the highest value of a measure");
 
     function("layer_summary_ml", &summary_ml, List::create( _["n"], _["layer"], _["method"] = "entropy.degree", _["mode"] = "all"), "Computes a summary of the input layer");
 
-    function("layer_comparison_ml", &comparison_ml, List::create( _["n"], _["layers"]=CharacterVector(), _["method"] = "jaccard.edges", _["mode"] = "all", _["K"] = 0), "Computes the similarity between the input layers");
+    function("layer_comparison_ml", &comparison_ml, List::create( _["n"], _["layers"]=CharacterVector(), _["method"] = "jaccard.edges", _["mode"] = "all", _["K"] = 0, _["approx"] = false, _["sketch.size"] = 256, _["threads"] = 0), "Computes the similarity between the input layers");
+
+    function("triangles_ml", &triangles_ml, List::create( _["n"], _["layers"]=CharacterVector(), _["local"] = false, _["threads"] = 0), "Counts the triangles in each layer, or in the neighborhood of each vertex");
+    function("coreness_ml", &coreness_ml, List::create( _["n"], _["layers"]=CharacterVector(), _["threads"] = 0), "Computes the coreness of each vertex in each layer");
+    function("cores_ml", &cores_ml, List::create( _["n"], _["layers"]=CharacterVector(), _["threads"] = 0), "Lists all the non-empty multilayer cores");
+    function("core_ml", &core_ml, List::create( _["n"], _["k"], _["layers"]=CharacterVector(), _["threads"] = 0), "Returns the network restricted to a multilayer core");
+    function("components_ml", &components_ml, List::create( _["n"], _["layers"]=CharacterVector(), _["mode"] = "weak", _["graph"] = "layers", _["isolated"] = true, _["sizes"] = false, _["threads"] = 0), "Computes the connected components of the layers or of the whole network");
+    function("layer_stats_ml", &layer_stats_ml, List::create( _["n"], _["layers"]=CharacterVector(), _["flat"] = true, _["samples"] = 0, _["delta"] = 0.1, _["seed"] = -1, _["threads"] = 0), "Computes basic statistics of the flattened network and of each layer");
 
 
-    function("distance_ml", &distance_ml, List::create( _["n"], _["from"], _["to"]=CharacterVector(), _["method"] = "multiplex"), "Computes the distance between two actors");
+    function("distance_ml", &distance_ml, List::create( _["n"], _["from"], _["to"]=CharacterVector(), _["method"] = "multiplex", _["max.length"] = 0, _["threads"] = 0), "Computes the distance between actors");
+    function("distance_matrix_ml", &distance_matrix_ml, List::create( _["n"], _["method"] = "multiplex", _["max.length"] = 0, _["file"] = "", _["memory.limit"] = 1024, _["threads"] = 0, _["progress"] = false), "Computes the distances between all pairs of actors");
+    function("betweenness_ml", &betweenness_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all", _["samples"] = 0, _["delta"] = 0.1, _["seed"] = -1, _["threads"] = 0), "Returns the (estimated) betweenness of each actor");
+    function("closeness_ml", &closeness_ml, List::create( _["n"], _["actors"]=CharacterVector(), _["layers"]=CharacterVector(), _["mode"] = "all", _["samples"] = 0, _["delta"] = 0.1, _["seed"] = -1, _["threads"] = 0), "Returns the (estimated) harmonic closeness of each actor");
+    function("random_walks_ml", &random_walks_ml, List::create( _["n"], _["length"] = 10, _["walks"] = 1, _["actors"]=CharacterVector(), _["switching"] = NumericMatrix(0,0), _["weight"] = "", _["interlayer"] = true, _["seed"] = -1, _["threads"] = 0), "Simulates random walks starting from each vertex");
 
 
     // CLUSTERING
@@ -219,28 +230,43 @@ RCPP_MODULE(multinet)
              List::create(
                           _["n"],
                           _["k"]=3,
-                          _["m"]=1
+                          _["m"]=1,
+                          _["threads"]=0,
+                          _["compact"]=false
             ), "Extension of the clique percolation method");
     
 
     function("glouvain_ml",
              &glouvain_ml,
-             List::create(_["n"],_["gamma"]=1,_["omega"]=1),
+             List::create(_["n"],_["gamma"]=1,_["omega"]=1,_["coupling"]="categorical",_["deterministic"]=false,
+                          _["initial"]=DataFrame(),_["threads"]=0,_["compact"]=false),
              "Extension of the louvain method");
+
+    function("glouvain_sweep_ml",
+             &glouvain_sweep_ml,
+             List::create(_["n"],_["gammas"],_["omegas"],_["coupling"]="categorical",_["deterministic"]=false,
+                          _["warm.start"]=true,_["threads"]=0,_["compact"]=false),
+             "Generalized louvain method on a grid of values of gamma and omega");
     
-    function("abacus_ml", &abacus_ml,List::create(_["n"],_["min.actors"]=3,_["min.layers"]=1),
+    function("abacus_ml", &abacus_ml,List::create(_["n"],_["min.actors"]=3,_["min.layers"]=1,
+                                                  _["max.itemsets"]=0,_["max.time"]=0,_["threads"]=0,
+                                                  _["compact"]=false),
             "Community extraction based on frequent itemset mining");
     
     function("flat_ec_ml",
              &flat_ec,
              List::create(
-                _["n"]
+                _["n"],
+                _["threads"]=0,
+                _["compact"]=false
             ), "Flattening-based method, weighted");
     
     function("flat_nw_ml",
              &flat_nw,
              List::create(
-                _["n"]
+                _["n"],
+                _["threads"]=0,
+                _["compact"]=false
             ), "Flattening-based method, unweighted");
     
     function("infomap_ml",
@@ -250,20 +276,45 @@ RCPP_MODULE(multinet)
     function("mdlp_ml",
              &mdlp,
              List::create(
-                _["n"]
+                _["n"],
+                _["initial"]=DataFrame(),
+                _["deterministic"]=false,
+                _["seed"]=-1,
+                _["threads"]=0,
+                _["compact"]=false
             ), "Multidimensional label propagation method");
+
+    function("consensus_ml",
+             &consensus_ml,
+             List::create(
+                _["n"],
+                _["algorithm"]="glouvain",
+                _["runs"]=100,
+                _["threshold"]=0.5,
+                _["gamma"]=1,
+                _["omega"]=1,
+                _["seed"]=-1,
+                _["threads"]=0,
+                _["compact"]=false
+            ), "Consensus of repeated runs of a community detection method");
     
     function("modularity_ml",
              &modularity_ml,
-             List::create(_["n"], _["comm.struct"],_["gamma"]=1,_["omega"]=1),
+             List::create(_["n"], _["comm.struct"],_["gamma"]=1,_["omega"]=1,_["threads"]=0),
              "Generalized modularity");
+
+    function("modularity_delta_ml",
+             &modularity_delta_ml,
+             List::create(_["n"], _["comm.struct"],_["moves"],_["gamma"]=1,_["omega"]=1,_["threads"]=0),
+             "Change of generalized modularity for each of a set of vertex moves");
     
     function("nmi_ml",
              &nmi,
              List::create(
                 _["n"],
                 _["com1"],
-                _["com2"]),
+                _["com2"],
+                _["threads"]=0),
              "Normalized Mutual Information"
              );
     
@@ -272,9 +323,21 @@ RCPP_MODULE(multinet)
              List::create(
                 _["n"],
                 _["com1"],
-                _["com2"]),
+                _["com2"],
+                _["threads"]=0),
              "Omega Index"
              );
+
+    function("compare_communities_ml",
+             &compare_communities_ml,
+             List::create(
+                _["n"],
+                _["com"],
+                _["candidates"],
+                _["method"]="nmi",
+                _["threads"]=0),
+             "Compares a community structure with a list of others"
+             );
     
     // FOR VISUALIZATION
     
@@ -287,6 +350,10 @@ RCPP_MODULE(multinet)
 
     function("get_community_list_ml", &to_list, List::create( _["comm.struct"], _["n"]), "Converts a community structure (data frame) into a list of communities, layer by layer");
 
+    function("compact_communities_ml", &compact_communities_ml, List::create( _["n"], _["comm.struct"]), "Converts a community structure into the compact format");
+
+    function("expand_communities_ml", &expand_communities_ml, List::create( _["n"], _["comm.struct"]), "Converts a community structure into a data frame with actor and layer names");
+
     /*
 
      //function("sir_ml", &sir_ml, List::create( _["n"], _["beta"], _["tau"], _["num_iterations"] = 1000), "Executes a SIR spreading process, returning the number of vertices in each status at each iteration");
@@ -1,6 +1,8 @@
 #include "rcpp_utils.h"
 #include "objects/MLVertex.hpp"
 #include <algorithm>
+#include <cstdio>
+#include <unordered_map>
 
 std::vector<const uu::net::Network*>
 resolve_const_layers(
@@ -484,6 +486,40 @@ resolve_mode(
     return uu::net::EdgeMode::INOUT; // never reaches here
 }
 
+Coupling
+resolve_coupling(
+    const std::string& coupling
+)
+{
+    if (coupling=="categorical")
+    {
+        return Coupling::CATEGORICAL;
+    }
+
+    else if (coupling=="ordinal")
+    {
+        return Coupling::ORDINAL;
+    }
+
+    Rcpp::stop("Unexpected value: coupling");
+
+    return Coupling::CATEGORICAL; // never reaches here
+}
+
+uint64_t
+resolve_seed(
+    int seed
+)
+{
+    if (seed >= 0)
+    {
+        return seed;
+    }
+
+    Rcpp::RNGScope scope;
+    return (uint64_t)(R::unif_rand() * 4294967296.0);
+}
+
 Rcpp::DataFrame
 to_dataframe(
     uu::net::CommunityStructure<uu::net::MultilayerNetwork>* cs
@@ -526,6 +562,392 @@ to_dataframe(
            );
 }
 
+Rcpp::DataFrame
+to_dataframe(
+    const MLIndex& idx,
+    const std::vector<int>& membership,
+    size_t num_communities
+)
+{
+    // vertices sorted by community (counting sort)
+    std::vector<size_t> start(num_communities + 1, 0);
+
+    for (auto c: membership)
+    {
+        start[c + 1]++;
+    }
+
+    for (size_t c = 0; c < num_communities; c++)
+    {
+        start[c+1] += start[c];
+    }
+
+    size_t num_rows = membership.size();
+    Rcpp::CharacterVector actor(num_rows);
+    Rcpp::CharacterVector layer(num_rows);
+    Rcpp::NumericVector community_id(num_rows);
+
+    for (size_t l = 0; l < idx.num_layers(); l++)
+    {
+        auto& li = idx.layers[l];
+
+        for (size_t i = 0; i < li.num_vertices(); i++)
+        {
+            int c = membership[li.offset + i];
+            size_t row_num = start[c]++;
+            actor[row_num] = idx.actors[li.actor[i]]->name;
+            layer[row_num] = li.layer->name;
+            community_id[row_num] = c;
+        }
+    }
+
+    return Rcpp::DataFrame::create(
+               _("actor")=actor,
+               _("layer")=layer,
+               _("cid")=community_id
+           );
+}
+
+Rcpp::DataFrame
+to_dataframe(
+    const MLIndex& idx,
+    const VertexCommunities& communities
+)
+{
+    size_t num_rows = communities.vertex.size();
+    Rcpp::CharacterVector actor(num_rows);
+    Rcpp::CharacterVector layer(num_rows);
+    Rcpp::NumericVector community_id(num_rows);
+
+    for (size_t c = 0; c < communities.num_communities(); c++)
+    {
+        for (size_t row_num = communities.start[c]; row_num < communities.start[c+1]; row_num++)
+        {
+            auto& li = idx.layers[communities.layer[row_num]];
+            actor[row_num] = idx.actors[li.actor[communities.vertex[row_num]]]->name;
+            layer[row_num] = li.layer->name;
+            community_id[row_num] = c;
+        }
+    }
+
+    return Rcpp::DataFrame::create(
+               _("actor")=actor,
+               _("layer")=layer,
+               _("cid")=community_id
+           );
+}
+
+std::string
+fingerprint(
+    const MLIndex& idx
+)
+{
+    // FNV-1a over the actor names, then the layer names and the actors of their vertices,
+    // in order; names are preceded by their length, so that they cannot be split differently
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    auto mix = [&](uint64_t x)
+    {
+        for (size_t i = 0; i < 8; i++)
+        {
+            h ^= (x >> (8 * i)) & 0xff;
+            h *= 0x100000001b3ULL;
+        }
+    };
+
+    auto mix_name = [&](const std::string& name)
+    {
+        mix(name.size());
+
+        for (auto ch: name)
+        {
+            mix((unsigned char)ch);
+        }
+    };
+
+    mix(idx.num_actors());
+
+    for (auto actor: idx.actors)
+    {
+        mix_name(actor->name);
+    }
+
+    for (auto& li: idx.layers)
+    {
+        mix_name(li.layer->name);
+        mix(li.num_vertices());
+
+        for (auto a: li.actor)
+        {
+            mix(a);
+        }
+    }
+
+    char res[17];
+    snprintf(res, sizeof(res), "%016llx", (unsigned long long)h);
+    return std::string(res);
+}
+
+Rcpp::DataFrame
+to_compact(
+    const MLIndex& idx,
+    const std::vector<int>& membership,
+    size_t num_communities
+)
+{
+    // vertices sorted by community (counting sort)
+    std::vector<size_t> start(num_communities + 1, 0);
+
+    for (auto c: membership)
+    {
+        start[c + 1]++;
+    }
+
+    for (size_t c = 0; c < num_communities; c++)
+    {
+        start[c+1] += start[c];
+    }
+
+    Rcpp::IntegerVector vertex(membership.size());
+    Rcpp::IntegerVector community_id(membership.size());
+
+    for (size_t v = 0; v < membership.size(); v++)
+    {
+        size_t row_num = start[membership[v]]++;
+        vertex[row_num] = v + 1;
+        community_id[row_num] = membership[v];
+    }
+
+    auto res = Rcpp::DataFrame::create(_("vertex")=vertex, _("cid")=community_id);
+    res.attr("fingerprint") = fingerprint(idx);
+    return res;
+}
+
+Rcpp::DataFrame
+to_compact(
+    const MLIndex& idx,
+    const VertexCommunities& communities
+)
+{
+    size_t num_rows = communities.vertex.size();
+    Rcpp::IntegerVector vertex(num_rows);
+    Rcpp::IntegerVector community_id(num_rows);
+
+    for (size_t c = 0; c < communities.num_communities(); c++)
+    {
+        for (size_t row_num = communities.start[c]; row_num < communities.start[c+1]; row_num++)
+        {
+            vertex[row_num] = idx.layers[communities.layer[row_num]].offset + communities.vertex[row_num] + 1;
+            community_id[row_num] = c;
+        }
+    }
+
+    auto res = Rcpp::DataFrame::create(_("vertex")=vertex, _("cid")=community_id);
+    res.attr("fingerprint") = fingerprint(idx);
+    return res;
+}
+
+bool
+is_compact(
+    const DataFrame& com
+)
+{
+    return com.containsElementNamed("vertex");
+}
+
+std::vector<int>
+to_vertices(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+)
+{
+    std::vector<int> res(com.nrow());
+
+    if (is_compact(com))
+    {
+        // the fingerprint is lost when subsetting the data frame in R
+        if (com.hasAttribute("fingerprint") && as<std::string>(com.attr("fingerprint")) != fingerprint(idx))
+        {
+            stop("the community structure was not computed on this network (or the network has changed since)");
+        }
+
+        IntegerVector cs_vertex = com["vertex"];
+
+        for (size_t i=0; i<com.nrow(); i++)
+        {
+            if (cs_vertex[i] == NA_INTEGER || cs_vertex[i] < 1 || (size_t)cs_vertex[i] > idx.num_vertices)
+            {
+                stop("vertex positions must be between 1 and the number of vertices");
+            }
+
+            res[i] = cs_vertex[i] - 1;
+        }
+
+        return res;
+    }
+
+    CharacterVector cs_actor = com["actor"];
+    CharacterVector cs_layer = com["layer"];
+
+    for (size_t i=0; i<com.nrow(); i++)
+    {
+        auto layer = mnet->layers()->get(std::string(cs_layer[i]));
+        if (!layer) stop("cannot find layer " + std::string(cs_layer[i]) + " (community structure not compatible with this network?)");
+        auto actor = mnet->actors()->get(std::string(cs_actor[i]));
+        if (!actor) stop("cannot find actor " + std::string(cs_actor[i]) + " (community structure not compatible with this network?)");
+
+        size_t l = mnet->layers()->index_of(layer);
+        int v = idx.vertex_of[l][mnet->actors()->index_of(actor)];
+        if (v < 0) stop("actor " + actor->name + " is not present in layer " + layer->name);
+
+        res[i] = idx.layers[l].offset + v;
+    }
+
+    return res;
+}
+
+Rcpp::DataFrame
+to_dataframe(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+)
+{
+    auto vertices = to_vertices(com, idx, mnet);
+    NumericVector cs_cid = com["cid"];
+
+    Rcpp::CharacterVector actor(vertices.size());
+    Rcpp::CharacterVector layer(vertices.size());
+    Rcpp::NumericVector community_id(vertices.size());
+
+    for (size_t i=0; i<vertices.size(); i++)
+    {
+        auto& li = idx.layers[idx.layer_of(vertices[i])];
+        actor[i] = idx.actors[li.actor[vertices[i] - li.offset]]->name;
+        layer[i] = li.layer->name;
+        community_id[i] = cs_cid[i];
+    }
+
+    return Rcpp::DataFrame::create(
+               _("actor")=actor,
+               _("layer")=layer,
+               _("cid")=community_id
+           );
+}
+
+Rcpp::DataFrame
+to_compact(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+)
+{
+    auto vertices = to_vertices(com, idx, mnet);
+    NumericVector cs_cid = com["cid"];
+
+    Rcpp::IntegerVector vertex(vertices.size());
+    Rcpp::IntegerVector community_id(vertices.size());
+
+    for (size_t i=0; i<vertices.size(); i++)
+    {
+        vertex[i] = vertices[i] + 1;
+        community_id[i] = cs_cid[i];
+    }
+
+    auto res = Rcpp::DataFrame::create(_("vertex")=vertex, _("cid")=community_id);
+    res.attr("fingerprint") = fingerprint(idx);
+    return res;
+}
+
+std::vector<int>
+to_membership(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet,
+    std::unordered_map<long, int>* ids
+)
+{
+    auto vertices = to_vertices(com, idx, mnet);
+    NumericVector cs_cid = com["cid"];
+
+    std::vector<int> membership(idx.num_vertices, -1);
+    std::unordered_map<long, int> id;
+
+    for (size_t i=0; i<vertices.size(); i++)
+    {
+        auto c = id.insert(std::make_pair((long)cs_cid[i], (int)id.size())).first->second;
+        int& m = membership[vertices[i]];
+
+        if (m >= 0 && m != c)
+        {
+            auto& li = idx.layers[idx.layer_of(vertices[i])];
+            stop("the communities must be a partition: vertex " + idx.actors[li.actor[vertices[i] - li.offset]]->name + "::" + li.layer->name + " is in more than one community");
+        }
+
+        m = c;
+    }
+
+    // vertices without a community are alone in a new one
+    int next = id.size();
+
+    if (ids)
+    {
+        ids->swap(id);
+    }
+
+    for (auto& m: membership)
+    {
+        if (m < 0)
+        {
+            m = next++;
+        }
+    }
+
+    return membership;
+}
+
+VertexCover
+to_cover(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+)
+{
+    auto vertices = to_vertices(com, idx, mnet);
+    NumericVector cs_cid = com["cid"];
+
+    // (vertex, community) pairs
+    std::vector<std::pair<int, int>> pairs(vertices.size());
+    std::unordered_map<long, int> id;
+
+    for (size_t i=0; i<vertices.size(); i++)
+    {
+        auto c = id.insert(std::make_pair((long)cs_cid[i], (int)id.size())).first->second;
+        pairs[i] = std::make_pair(vertices[i], c);
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    VertexCover cover;
+    cover.start.assign(idx.num_vertices + 1, 0);
+    cover.community.resize(pairs.size());
+
+    for (size_t i=0; i<pairs.size(); i++)
+    {
+        cover.start[pairs[i].first + 1]++;
+        cover.community[i] = pairs[i].second;
+    }
+
+    for (size_t v=0; v<idx.num_vertices; v++)
+    {
+        cover.start[v+1] += cover.start[v];
+    }
+
+    return cover;
+}
+
 std::unique_ptr<uu::net::CommunityStructure<uu::net::MultilayerNetwork>>
 to_communities(
                const DataFrame& com,
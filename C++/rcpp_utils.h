@@ -2,6 +2,9 @@
 #define UU_R_MULTINET_RCPP_UTILS_H_
 
 #include "Rcpp.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include "community/CommunityStructure.hpp"
@@ -11,6 +14,9 @@
 #include "community/Community.hpp"
 #include "networks/MultilayerNetwork.hpp"
 #include "r_functions.h"
+#include "communities.h"
+#include "ml_index.h"
+#include "glouvain.h"
 
 std::vector<const uu::net::Network*>
 resolve_const_layers(
@@ -78,11 +84,138 @@ resolve_mode(
     std::string mode
 );
 
+/** Coupling of generalized louvain from its name ("categorical" or "ordinal"). */
+Coupling
+resolve_coupling(
+    const std::string& coupling
+);
+
+/**
+ * Returns seed if non-negative, otherwise a seed drawn from the random number generator
+ * of R, so that results are reproducible after set.seed().
+ */
+uint64_t
+resolve_seed(
+    int seed
+);
+
 Rcpp::DataFrame
 to_dataframe(
     uu::net::CommunityStructure<uu::net::MultilayerNetwork>* cs
 );
 
+/**
+ * Data frame (actor, layer, cid) of a partition of the vertices indexed by idx, where
+ * membership[v] is the community of the vertex with global position v. Rows are
+ * grouped by community, as in the other to_dataframe().
+ */
+Rcpp::DataFrame
+to_dataframe(
+    const MLIndex& idx,
+    const std::vector<int>& membership,
+    size_t num_communities
+);
+
+/**
+ * Data frame with the vertices of each (possibly overlapping) community, in the same
+ * format.
+ */
+Rcpp::DataFrame
+to_dataframe(
+    const MLIndex& idx,
+    const VertexCommunities& communities
+);
+
+/**
+ * Fingerprint of the vertices indexed by idx (the names of the actors and of the layers,
+ * and the actors of the vertices of each layer in order), stored in compact community structures to check that they
+ * are used on the network where they were computed.
+ */
+std::string
+fingerprint(
+    const MLIndex& idx
+);
+
+/**
+ * Compact community structure: a data frame with integer columns vertex (global position
+ * of the vertex from 1, as in vertices_ml()) and cid, and the fingerprint of the network
+ * as attribute. Rows are grouped by community, as in to_dataframe().
+ */
+Rcpp::DataFrame
+to_compact(
+    const MLIndex& idx,
+    const std::vector<int>& membership,
+    size_t num_communities
+);
+
+Rcpp::DataFrame
+to_compact(
+    const MLIndex& idx,
+    const VertexCommunities& communities
+);
+
+/**
+ * Conversions of a community structure in any format to a compact one, and to a data
+ * frame (actor, layer, cid), keeping the order of the rows.
+ */
+Rcpp::DataFrame
+to_compact(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+);
+
+Rcpp::DataFrame
+to_dataframe(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+);
+
+/**
+ * True if com is a compact community structure.
+ */
+bool
+is_compact(
+    const DataFrame& com
+);
+
+/**
+ * Global position in idx of the vertex of each row of a community structure, compact or
+ * not.
+ */
+std::vector<int>
+to_vertices(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+);
+
+/**
+ * Inverse of the to_dataframe function for partitions: community of each vertex indexed by idx (global
+ * position), numbered from 0 in order of first appearance in com. Vertices that are not
+ * in com are put in a community of their own. If ids is not null, it is set to the
+ * number of each cid in com.
+ */
+std::vector<int>
+to_membership(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet,
+    std::unordered_map<long, int>* ids = nullptr
+);
+
+/**
+ * Communities of each vertex indexed by idx, for possibly overlapping communities, with
+ * cids numbered from 0 in order of first appearance in com.
+ */
+VertexCover
+to_cover(
+    const DataFrame& com,
+    const MLIndex& idx,
+    const uu::net::MultilayerNetwork* mnet
+);
+
 std::unique_ptr<uu::net::CommunityStructure<uu::net::MultilayerNetwork>>
 to_communities(
                const DataFrame& com,
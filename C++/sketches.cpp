@@ -0,0 +1,258 @@
+#include "sketches.h"
+#include "parallel.h"
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+// finalizer of splitmix64
+uint64_t
+mix64(
+    uint64_t x
+)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+std::unordered_map<const uu::net::Vertex*, uint64_t>
+actor_hashes(
+    const uu::net::MultilayerNetwork* mnet
+)
+{
+    std::unordered_map<const uu::net::Vertex*, uint64_t> res;
+    res.reserve(mnet->actors()->size());
+
+    for (auto actor: *mnet->actors())
+    {
+        res[actor] = hash_name(actor->name);
+    }
+
+    return res;
+}
+
+}
+
+BottomKSketch::
+BottomKSketch(
+    size_t k
+) : k_(std::max<size_t>(k, 1)), threshold_(std::numeric_limits<uint64_t>::max())
+{
+    values_.reserve(2 * k_);
+}
+
+void
+BottomKSketch::
+add(
+    uint64_t hash
+)
+{
+    if (hash >= threshold_)
+    {
+        return;
+    }
+
+    values_.push_back(hash);
+
+    if (values_.size() >= 2 * k_)
+    {
+        compact();
+    }
+}
+
+void
+BottomKSketch::
+finalize(
+)
+{
+    compact();
+    values_.shrink_to_fit();
+}
+
+size_t
+BottomKSketch::
+k(
+) const
+{
+    return k_;
+}
+
+const std::vector<uint64_t>&
+BottomKSketch::
+values(
+) const
+{
+    return values_;
+}
+
+void
+BottomKSketch::
+compact(
+)
+{
+    std::sort(values_.begin(), values_.end());
+    values_.erase(std::unique(values_.begin(), values_.end()), values_.end());
+
+    if (values_.size() >= k_)
+    {
+        values_.resize(k_);
+        threshold_ = values_.back();
+    }
+}
+
+double
+estimate_jaccard(
+    const BottomKSketch& s1,
+    const BottomKSketch& s2
+)
+{
+    size_t k = std::min(s1.k(), s2.k());
+    auto& v1 = s1.values();
+    auto& v2 = s2.values();
+
+    // the k smallest values of the union are a uniform sample of the union:
+    // count how many of them are in both sets
+    size_t i = 0;
+    size_t j = 0;
+    size_t sampled = 0;
+    size_t common = 0;
+
+    while (sampled < k && (i < v1.size() || j < v2.size()))
+    {
+        if (j == v2.size() || (i < v1.size() && v1[i] < v2[j]))
+        {
+            i++;
+        }
+        else if (i == v1.size() || v2[j] < v1[i])
+        {
+            j++;
+        }
+        else
+        {
+            common++;
+            i++;
+            j++;
+        }
+
+        sampled++;
+    }
+
+    if (sampled == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return (double)common / sampled;
+}
+
+double
+estimate_union_size(
+    const std::vector<const BottomKSketch*>& sketches
+)
+{
+    if (sketches.empty())
+    {
+        return 0;
+    }
+
+    size_t k = std::numeric_limits<size_t>::max();
+    std::vector<uint64_t> values;
+
+    for (auto s: sketches)
+    {
+        k = std::min(k, s->k());
+        values.insert(values.end(), s->values().begin(), s->values().end());
+    }
+
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    if (values.size() < k)
+    {
+        return values.size();
+    }
+
+    // k-minimum-values estimator
+    long double h = ((long double)values[k-1] + 1) / 18446744073709551616.0L;
+    return (double)((k - 1) / h);
+}
+
+uint64_t
+hash_name(
+    const std::string& name
+)
+{
+    // FNV-1a
+    uint64_t h = 0xcbf29ce484222325ULL;
+
+    for (unsigned char c: name)
+    {
+        h ^= c;
+        h *= 0x100000001b3ULL;
+    }
+
+    return mix64(h);
+}
+
+std::vector<BottomKSketch>
+actor_sketches(
+    const uu::net::MultilayerNetwork* mnet,
+    const std::vector<const uu::net::Network*>& layers,
+    size_t k,
+    size_t num_threads
+)
+{
+    std::vector<BottomKSketch> res(layers.size(), BottomKSketch(k));
+    auto hashes = actor_hashes(mnet);
+
+    parallel_for(layers.size(), num_threads, [&](size_t l, size_t)
+    {
+        for (auto actor: *layers[l]->vertices())
+        {
+            res[l].add(hashes.at(actor));
+        }
+
+        res[l].finalize();
+    });
+
+    return res;
+}
+
+std::vector<BottomKSketch>
+edge_sketches(
+    const uu::net::MultilayerNetwork* mnet,
+    const std::vector<const uu::net::Network*>& layers,
+    size_t k,
+    size_t num_threads
+)
+{
+    std::vector<BottomKSketch> res(layers.size(), BottomKSketch(k));
+    auto hashes = actor_hashes(mnet);
+
+    parallel_for(layers.size(), num_threads, [&](size_t l, size_t)
+    {
+        bool directed = layers[l]->is_directed();
+
+        for (auto edge: *layers[l]->edges())
+        {
+            uint64_t h1 = hashes.at(edge->v1);
+            uint64_t h2 = hashes.at(edge->v2);
+
+            if (!directed && h2 < h1)
+            {
+                std::swap(h1, h2);
+            }
+
+            res[l].add(mix64(h1 ^ mix64(h2 + 0x9e3779b97f4a7c15ULL)));
+        }
+
+        res[l].finalize();
+    });
+
+    return res;
+}
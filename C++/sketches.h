@@ -0,0 +1,106 @@
+#ifndef UU_R_MULTINET_SKETCHES_H_
+#define UU_R_MULTINET_SKETCHES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "networks/MultilayerNetwork.hpp"
+
+/**
+ * Bottom-k MinHash sketch: the k smallest distinct hash values of a set.
+ *
+ * The sketch is built in one streaming pass using O(k) memory, and can be used to estimate
+ * the Jaccard similarity of two sets and the cardinality of their union with relative standard
+ * error close to 1/sqrt(k).
+ */
+class BottomKSketch
+{
+  public:
+
+    explicit
+    BottomKSketch(
+        size_t k
+    );
+
+    void
+    add(
+        uint64_t hash
+    );
+
+    /** Must be called after the last add() and before estimating. */
+    void
+    finalize(
+    );
+
+    size_t
+    k(
+    ) const;
+
+    /** Sorted hash values (at most k). */
+    const std::vector<uint64_t>&
+    values(
+    ) const;
+
+  private:
+
+    size_t k_;
+    uint64_t threshold_;
+    std::vector<uint64_t> values_;
+
+    void
+    compact(
+    );
+};
+
+/**
+ * Estimated Jaccard similarity between the sets summarized by the two sketches.
+ */
+double
+estimate_jaccard(
+    const BottomKSketch& s1,
+    const BottomKSketch& s2
+);
+
+/**
+ * Estimated number of distinct elements in the union of the sets summarized by the sketches
+ * (exact if the union contains less than k elements).
+ */
+double
+estimate_union_size(
+    const std::vector<const BottomKSketch*>& sketches
+);
+
+/**
+ * Deterministic 64-bit hash of a string (independent of platform and execution).
+ */
+uint64_t
+hash_name(
+    const std::string& name
+);
+
+/**
+ * Sketches of the set of actors of each input layer, built in parallel over the layers.
+ */
+std::vector<BottomKSketch>
+actor_sketches(
+    const uu::net::MultilayerNetwork* mnet,
+    const std::vector<const uu::net::Network*>& layers,
+    size_t k,
+    size_t num_threads
+);
+
+/**
+ * Sketches of the set of edges of each input layer, built in parallel over the layers.
+ * Edges are identified by their end actors: on undirected layers (a,b) and (b,a)
+ * are the same edge.
+ */
+std::vector<BottomKSketch>
+edge_sketches(
+    const uu::net::MultilayerNetwork* mnet,
+    const std::vector<const uu::net::Network*>& layers,
+    size_t k,
+    size_t num_threads
+);
+
+#endif
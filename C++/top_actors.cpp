@@ -0,0 +1,362 @@
+#include "top_actors.h"
+#include "parallel.h"
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// total order used for the ranking: higher values first, then lower positions
+bool
+better(
+    const RankedActor& a,
+    const RankedActor& b
+)
+{
+    return a.value > b.value || (a.value == b.value && a.actor < b.actor);
+}
+
+// bounded heap of the best k actors, with the worst one on top
+void
+offer(
+    std::vector<RankedActor>& heap,
+    size_t k,
+    const RankedActor& r
+)
+{
+    if (heap.size() < k)
+    {
+        heap.push_back(r);
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+
+    else if (better(r, heap.front()))
+    {
+        std::pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = r;
+        std::push_heap(heap.begin(), heap.end(), better);
+    }
+}
+
+// counts distinct neighbors using timestamps, so that no clearing is needed between actors
+class NeighborCounter
+{
+  public:
+
+    NeighborCounter(
+        const MLIndex& idx,
+        const std::vector<size_t>& layers,
+        bool out,
+        bool in
+    ) : idx_(idx), layers_(layers), out_(out), in_(in),
+        selected_(idx.num_layers(), false), mark_(idx.num_actors(), 0), other_(idx.num_actors(), 0), stamp_(0)
+    {
+        for (auto l: layers)
+        {
+            selected_[l] = true;
+        }
+    }
+
+    // neighbors on the selected layers (not adjacent on the other layers, if exclusive)
+    size_t
+    count(
+        int a,
+        bool exclusive
+    )
+    {
+        stamp_++;
+
+        if (exclusive)
+        {
+            for (size_t l = 0; l < idx_.num_layers(); l++)
+            {
+                if (!selected_[l])
+                {
+                    visit(l, a, [&](int b)
+                    {
+                        other_[b] = stamp_;
+                    });
+                }
+            }
+        }
+
+        size_t c = 0;
+
+        for (auto l: layers_)
+        {
+            visit(l, a, [&](int b)
+            {
+                if (mark_[b] != stamp_)
+                {
+                    mark_[b] = stamp_;
+
+                    if (!exclusive || other_[b] != stamp_)
+                    {
+                        c++;
+                    }
+                }
+            });
+        }
+
+        return c;
+    }
+
+    // neighbors on all layers
+    size_t
+    count_all(
+        int a
+    )
+    {
+        stamp_++;
+        size_t c = 0;
+
+        for (size_t l = 0; l < idx_.num_layers(); l++)
+        {
+            visit(l, a, [&](int b)
+            {
+                if (mark_[b] != stamp_)
+                {
+                    mark_[b] = stamp_;
+                    c++;
+                }
+            });
+        }
+
+        return c;
+    }
+
+  private:
+
+    const MLIndex& idx_;
+    const std::vector<size_t>& layers_;
+    bool out_;
+    bool in_;
+    std::vector<bool> selected_;
+    std::vector<unsigned> mark_;
+    std::vector<unsigned> other_;
+    unsigned stamp_;
+
+    template <typename F>
+    void
+    visit(
+        size_t l,
+        int a,
+        F f
+    ) const
+    {
+        int v = idx_.vertex_of[l][a];
+
+        if (v < 0)
+        {
+            return;
+        }
+
+        auto& li = idx_.layers[l];
+
+        if (li.loop[v])
+        {
+            f(a);
+        }
+
+        // on undirected layers the out lists contain all the neighbors
+        if (out_ || !li.directed)
+        {
+            for (auto p = li.out_begin(v); p != li.out_end(v); ++p)
+            {
+                f(li.actor[*p]);
+            }
+        }
+
+        if (in_ && li.directed)
+        {
+            for (auto p = li.in_begin(v); p != li.in_end(v); ++p)
+            {
+                f(li.actor[*p]);
+            }
+        }
+    }
+};
+
+}
+
+std::vector<RankedActor>
+top_actors(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    ActorMeasure measure,
+    bool out,
+    bool in,
+    size_t k,
+    size_t num_threads
+)
+{
+    size_t n = idx.num_actors();
+    std::vector<RankedActor> top;
+
+    if (k == 0 || n == 0)
+    {
+        return top;
+    }
+
+    // degree on the selected layers, and whether the actor is on one of them
+
+    std::vector<size_t> deg(n, 0);
+    std::vector<char> present(n, 0);
+
+    parallel_for(n, num_threads, [&](size_t a, size_t)
+    {
+        for (auto l: layers)
+        {
+            int v = idx.vertex_of[l][a];
+
+            if (v < 0)
+            {
+                continue;
+            }
+
+            auto& li = idx.layers[l];
+            present[a] = 1;
+            deg[a] += li.loop[v];
+
+            if (out || !li.directed)
+            {
+                deg[a] += li.out_degree(v);
+            }
+
+            if (in && li.directed)
+            {
+                deg[a] += li.in_degree(v);
+            }
+        }
+    }, 4096);
+
+    std::vector<std::vector<RankedActor>> heaps(num_threads);
+    std::vector<std::unique_ptr<NeighborCounter>> counters(num_threads);
+
+    auto counter = [&](size_t t) -> NeighborCounter&
+    {
+        if (!counters[t])
+        {
+            counters[t].reset(new NeighborCounter(idx, layers, out, in));
+        }
+
+        return *counters[t];
+    };
+
+    auto merge = [&]()
+    {
+        for (auto& heap: heaps)
+        {
+            for (auto& r: heap)
+            {
+                offer(top, k, r);
+            }
+
+            heap.clear();
+        }
+    };
+
+    if (measure == ActorMeasure::DEGREE || measure == ActorMeasure::RELEVANCE || measure == ActorMeasure::XRELEVANCE)
+    {
+        bool exclusive = measure == ActorMeasure::XRELEVANCE;
+
+        parallel_for(n, num_threads, [&](size_t a, size_t t)
+        {
+            if (!present[a])
+            {
+                return;
+            }
+
+            if (measure == ActorMeasure::DEGREE)
+            {
+                offer(heaps[t], k, RankedActor {(int)a, (double)deg[a]});
+                return;
+            }
+
+            auto& c = counter(t);
+            size_t all = c.count_all(a);
+
+            if (all > 0)
+            {
+                offer(heaps[t], k, RankedActor {(int)a, (double)c.count(a, exclusive) / all});
+            }
+        }, 1024);
+
+        merge();
+    }
+
+    else
+    {
+        bool exclusive = measure == ActorMeasure::XNEIGHBORHOOD;
+
+        // present actors by decreasing degree (counting sort, stable on the position)
+
+        size_t max_deg = 0;
+
+        for (size_t a = 0; a < n; a++)
+        {
+            max_deg = std::max(max_deg, deg[a]);
+        }
+
+        std::vector<size_t> first(max_deg + 2, 0);
+
+        for (size_t a = 0; a < n; a++)
+        {
+            if (present[a])
+            {
+                first[max_deg - deg[a] + 1]++;
+            }
+        }
+
+        for (size_t d = 0; d <= max_deg; d++)
+        {
+            first[d+1] += first[d];
+        }
+
+        std::vector<int> order(first[max_deg + 1]);
+
+        for (size_t a = 0; a < n; a++)
+        {
+            if (present[a])
+            {
+                order[first[max_deg - deg[a]]++] = a;
+            }
+        }
+
+        // rounds of increasing size: after each round the global top k is updated,
+        // and actors whose degree is lower than the k-th value cannot enter it
+
+        size_t round = 1024 * num_threads;
+        size_t pos = 0;
+
+        while (pos < order.size())
+        {
+            double threshold = top.size() == k ? top.front().value : -1;
+
+            if (deg[order[pos]] < threshold)
+            {
+                break;
+            }
+
+            size_t end = std::min(order.size(), pos + round);
+
+            parallel_for(end - pos, num_threads, [&](size_t i, size_t t)
+            {
+                int a = order[pos + i];
+
+                if (deg[a] < threshold)
+                {
+                    return;
+                }
+
+                offer(heaps[t], k, RankedActor {a, (double)counter(t).count(a, exclusive)});
+            }, 256);
+
+            merge();
+            pos = end;
+            round = std::min<size_t>(round * 2, 1 << 20);
+        }
+    }
+
+    std::sort(top.begin(), top.end(), better);
+    return top;
+}
@@ -0,0 +1,52 @@
+#ifndef UU_R_MULTINET_TOP_ACTORS_H_
+#define UU_R_MULTINET_TOP_ACTORS_H_
+
+#include <cstddef>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Actor measures supported by top_actors(), with the same definitions used by
+ * degree_ml(), neighborhood_ml(), xneighborhood_ml(), relevance_ml() and xrelevance_ml():
+ * a self-loop is one incident edge, whichever the direction, and makes the actor its own
+ * neighbor.
+ */
+enum class ActorMeasure
+{
+    DEGREE,
+    NEIGHBORHOOD,
+    XNEIGHBORHOOD,
+    RELEVANCE,
+    XRELEVANCE
+};
+
+struct RankedActor
+{
+    // position in idx.actors
+    int actor;
+    double value;
+};
+
+/**
+ * Returns the (at most) k actors with the highest value of the measure on the input
+ * layers (indices in idx.layers), following outgoing edges (out), incoming edges (in)
+ * or both, sorted by decreasing value and then by actor position.
+ *
+ * Actors not present on the input layers, and for relevance actors without neighbors,
+ * are not ranked. Each thread keeps a heap with its best k actors; for neighborhoods,
+ * actors are visited by decreasing degree, which is an upper bound of their (exclusive)
+ * neighborhood, and the visit stops when no remaining actor can enter the top k.
+ * The result does not depend on the number of threads.
+ */
+std::vector<RankedActor>
+top_actors(
+    const MLIndex& idx,
+    const std::vector<size_t>& layers,
+    ActorMeasure measure,
+    bool out,
+    bool in,
+    size_t k,
+    size_t num_threads
+);
+
+#endif
@@ -0,0 +1,283 @@
+#include "triangles.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+LayerTriangles
+find_triangles(
+    const LayerIndex& layer,
+    size_t num_threads,
+    bool keep_triads
+)
+{
+    num_threads = std::max<size_t>(num_threads, 1);
+
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+    undirected_adjacency(layer, start, nbr);
+
+    size_t n = layer.num_vertices();
+
+    LayerTriangles res;
+    res.count = 0;
+    res.connected_triples = 0;
+
+    // orientation: from lower to higher (degree, position)
+    auto precedes = [&](size_t u, size_t v)
+    {
+        size_t du = start[u+1] - start[u];
+        size_t dv = start[v+1] - start[v];
+        return du < dv || (du == dv && u < v);
+    };
+
+    std::vector<size_t> fstart(n+1, 0);
+
+    for (size_t u = 0; u < n; u++)
+    {
+        size_t d = start[u+1] - start[u];
+        res.connected_triples += (double)d * (d - 1) / 2;
+
+        for (size_t i = start[u]; i < start[u+1]; i++)
+        {
+            if (precedes(u, nbr[i]))
+            {
+                fstart[u+1]++;
+            }
+        }
+    }
+
+    for (size_t u = 0; u < n; u++)
+    {
+        fstart[u+1] += fstart[u];
+    }
+
+    // forward lists remain sorted by position, so they can be intersected by merging
+    std::vector<int> fnbr(fstart[n]);
+
+    for (size_t u = 0; u < n; u++)
+    {
+        size_t pos = fstart[u];
+
+        for (size_t i = start[u]; i < start[u+1]; i++)
+        {
+            if (precedes(u, nbr[i]))
+            {
+                fnbr[pos++] = nbr[i];
+            }
+        }
+    }
+
+    std::vector<std::atomic<size_t>> local(n);
+
+    for (size_t u = 0; u < n; u++)
+    {
+        local[u].store(0, std::memory_order_relaxed);
+    }
+
+    std::vector<size_t> counts(num_threads, 0);
+    std::vector<std::vector<TriadKey>> buffers(num_threads);
+
+    parallel_for(n, num_threads, [&](size_t u, size_t t)
+    {
+        const int* ub = fnbr.data() + fstart[u];
+        const int* ue = fnbr.data() + fstart[u+1];
+
+        for (const int* pv = ub; pv != ue; ++pv)
+        {
+            size_t v = *pv;
+            const int* a = ub;
+            const int* b = fnbr.data() + fstart[v];
+            const int* be = fnbr.data() + fstart[v+1];
+
+            while (a != ue && b != be)
+            {
+                if (*a < *b)
+                {
+                    ++a;
+                }
+                else if (*b < *a)
+                {
+                    ++b;
+                }
+                else
+                {
+                    size_t w = *a;
+                    counts[t]++;
+                    local[u].fetch_add(1, std::memory_order_relaxed);
+                    local[v].fetch_add(1, std::memory_order_relaxed);
+                    local[w].fetch_add(1, std::memory_order_relaxed);
+
+                    if (keep_triads)
+                    {
+                        int k[3] = {layer.actor[u], layer.actor[v], layer.actor[w]};
+                        std::sort(k, k+3);
+                        buffers[t].push_back(TriadKey {k[0], k[1], k[2]});
+                    }
+
+                    ++a;
+                    ++b;
+                }
+            }
+        }
+    }, 64);
+
+    for (auto c: counts)
+    {
+        res.count += c;
+    }
+
+    res.local.resize(n);
+
+    for (size_t u = 0; u < n; u++)
+    {
+        res.local[u] = local[u].load(std::memory_order_relaxed);
+    }
+
+    if (keep_triads)
+    {
+        parallel_for(num_threads, num_threads, [&](size_t t, size_t)
+        {
+            std::sort(buffers[t].begin(), buffers[t].end());
+        });
+
+        res.triads.reserve(res.count);
+
+        for (auto& buffer: buffers)
+        {
+            size_t middle = res.triads.size();
+            res.triads.insert(res.triads.end(), buffer.begin(), buffer.end());
+            std::inplace_merge(res.triads.begin(), res.triads.begin() + middle, res.triads.end());
+            std::vector<TriadKey>().swap(buffer);
+        }
+    }
+
+    return res;
+}
+
+std::vector<double>
+local_clustering(
+    const LayerIndex& layer,
+    const LayerTriangles& triangles
+)
+{
+    std::vector<size_t> start;
+    std::vector<int> nbr;
+    undirected_adjacency(layer, start, nbr);
+
+    size_t n = layer.num_vertices();
+    std::vector<double> res(n);
+
+    for (size_t u = 0; u < n; u++)
+    {
+        double d = start[u+1] - start[u];
+
+        if (d < 2)
+        {
+            res[u] = std::numeric_limits<double>::quiet_NaN();
+        }
+        else
+        {
+            res[u] = 2.0 * triangles.local[u] / (d * (d - 1));
+        }
+    }
+
+    return res;
+}
+
+double
+transitivity(
+    const LayerTriangles& triangles
+)
+{
+    if (triangles.connected_triples == 0)
+    {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    return 3.0 * triangles.count / triangles.connected_triples;
+}
+
+size_t
+count_common_triads(
+    const std::vector<TriadKey>& t1,
+    const std::vector<TriadKey>& t2
+)
+{
+    size_t res = 0;
+    auto a = t1.begin();
+    auto b = t2.begin();
+
+    while (a != t1.end() && b != t2.end())
+    {
+        if (*a < *b)
+        {
+            ++a;
+        }
+        else if (*b < *a)
+        {
+            ++b;
+        }
+        else
+        {
+            res++;
+            ++a;
+            ++b;
+        }
+    }
+
+    return res;
+}
+
+size_t
+count_distinct_triads(
+    const std::vector<const std::vector<TriadKey>*>& lists
+)
+{
+    // k-way merge, to avoid materializing the union
+    typedef std::pair<TriadKey, size_t> Head;
+    auto greater = [](const Head& h1, const Head& h2)
+    {
+        return h2.first < h1.first;
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+    std::vector<size_t> pos(lists.size(), 0);
+
+    for (size_t i = 0; i < lists.size(); i++)
+    {
+        if (!lists[i]->empty())
+        {
+            heads.push(Head(lists[i]->front(), i));
+        }
+    }
+
+    size_t res = 0;
+    bool first = true;
+    TriadKey last = {0, 0, 0};
+
+    while (!heads.empty())
+    {
+        Head h = heads.top();
+        heads.pop();
+
+        if (first || !(h.first == last))
+        {
+            res++;
+            last = h.first;
+            first = false;
+        }
+
+        size_t i = h.second;
+
+        if (++pos[i] < lists[i]->size())
+        {
+            heads.push(Head((*lists[i])[pos[i]], i));
+        }
+    }
+
+    return res;
+}
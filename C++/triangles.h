@@ -0,0 +1,104 @@
+#ifndef UU_R_MULTINET_TRIANGLES_H_
+#define UU_R_MULTINET_TRIANGLES_H_
+
+#include <cstddef>
+#include <vector>
+#include "ml_index.h"
+
+/**
+ * Canonical key of a triangle: the actor indices of its three vertices, sorted.
+ */
+struct TriadKey
+{
+    int a;
+    int b;
+    int c;
+
+    bool
+    operator<(
+        const TriadKey& other
+    ) const
+    {
+        if (a != other.a) return a < other.a;
+        if (b != other.b) return b < other.b;
+        return c < other.c;
+    }
+
+    bool
+    operator==(
+        const TriadKey& other
+    ) const
+    {
+        return a == other.a && b == other.b && c == other.c;
+    }
+};
+
+/**
+ * Triangles of one layer, with the by-products of their enumeration.
+ * Edge directionality is ignored.
+ */
+struct LayerTriangles
+{
+    // number of triangles
+    size_t count;
+
+    // number of connected triples (paths of length 2), used for the global transitivity
+    double connected_triples;
+
+    // number of triangles containing each vertex of the layer
+    std::vector<size_t> local;
+
+    // sorted canonical keys of all triangles (only if requested)
+    std::vector<TriadKey> triads;
+};
+
+/**
+ * Lists the triangles of a layer using the compact-forward algorithm: edges are
+ * oriented from lower to higher degree and each triangle is found exactly once by
+ * intersecting the sorted forward adjacencies of the endpoints of an edge.
+ * Vertices are processed in parallel.
+ */
+LayerTriangles
+find_triangles(
+    const LayerIndex& layer,
+    size_t num_threads,
+    bool keep_triads
+);
+
+/**
+ * Local clustering coefficient of each vertex of the layer (NaN for vertices
+ * with fewer than two neighbors).
+ */
+std::vector<double>
+local_clustering(
+    const LayerIndex& layer,
+    const LayerTriangles& triangles
+);
+
+/**
+ * Global transitivity of the layer: 3 x triangles / connected triples (NaN if there
+ * are no connected triples).
+ */
+double
+transitivity(
+    const LayerTriangles& triangles
+);
+
+/**
+ * Number of triads present in both sorted lists.
+ */
+size_t
+count_common_triads(
+    const std::vector<TriadKey>& t1,
+    const std::vector<TriadKey>& t2
+);
+
+/**
+ * Number of distinct triads in the union of the sorted lists.
+ */
+size_t
+count_distinct_triads(
+    const std::vector<const std::vector<TriadKey>*>& lists
+);
+
+#endif
@@ -0,0 +1,402 @@
+#include "walks.h"
+#include "parallel.h"
+#include "core/exceptions/WrongParameterException.hpp"
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+
+struct Arc
+{
+    int from;
+    int to;
+    double weight;
+};
+
+// splitmix64 generator: small state, so that each walk can have its own stream
+struct SplitMix64
+{
+    uint64_t state;
+
+    explicit
+    SplitMix64(
+        uint64_t seed
+    ) : state(seed)
+    {
+    }
+
+    uint64_t
+    next(
+    )
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+// Vose's alias method: builds the tables of the k weights starting at w
+void
+build_alias(
+    const double* w,
+    size_t k,
+    double* prob,
+    int* alias
+)
+{
+    double total = 0;
+
+    for (size_t i = 0; i < k; i++)
+    {
+        total += w[i];
+    }
+
+    std::vector<size_t> small, large;
+
+    for (size_t i = 0; i < k; i++)
+    {
+        prob[i] = w[i] * k / total;
+        alias[i] = i;
+
+        if (prob[i] < 1)
+        {
+            small.push_back(i);
+        }
+
+        else
+        {
+            large.push_back(i);
+        }
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        size_t s = small.back();
+        size_t l = large.back();
+        small.pop_back();
+        alias[s] = l;
+        prob[l] -= 1 - prob[s];
+
+        if (prob[l] < 1)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // left-overs are 1 up to rounding errors
+    for (auto i: small)
+    {
+        prob[i] = 1;
+    }
+
+    for (auto i: large)
+    {
+        prob[i] = 1;
+    }
+}
+
+// samples one of the k entries of an alias table in constant time
+size_t
+sample_alias(
+    SplitMix64& rng,
+    const double* prob,
+    const int* alias,
+    size_t k
+)
+{
+    uint64_t r = rng.next();
+    size_t i = ((r >> 32) * k) >> 32;
+    double u = (r & 0xffffffffULL) * (1.0 / 4294967296.0);
+    return u < prob[i] ? i : alias[i];
+}
+
+double
+check_weight(
+    const uu::core::Value<double>& value
+)
+{
+    if (value.null)
+    {
+        return 1;
+    }
+
+    if (!(value.value >= 0) || std::isinf(value.value))
+    {
+        throw uu::core::WrongParameterException("edge weights must be non-negative numbers");
+    }
+
+    return value.value;
+}
+
+template <typename S>
+bool
+has_weights(
+    const S* attributes,
+    const std::string& weight
+)
+{
+    if (weight == "")
+    {
+        return false;
+    }
+
+    auto att = attributes->get(weight);
+
+    if (!att)
+    {
+        return false;
+    }
+
+    if (att->type != uu::core::AttributeType::DOUBLE)
+    {
+        throw uu::core::WrongParameterException("attribute " + weight + " is not numeric");
+    }
+
+    return true;
+}
+
+// CSR with alias tables from a list of arcs
+void
+build_tables(
+    std::vector<Arc>& arcs,
+    size_t n,
+    size_t num_threads,
+    std::vector<size_t>& start,
+    std::vector<int>& target,
+    std::vector<double>& prob,
+    std::vector<int>& alias
+)
+{
+    start.assign(n + 1, 0);
+
+    for (auto& arc: arcs)
+    {
+        start[arc.from + 1]++;
+    }
+
+    for (size_t v = 0; v < n; v++)
+    {
+        start[v+1] += start[v];
+    }
+
+    std::vector<size_t> pos(start.begin(), start.end() - 1);
+    std::vector<double> weights(arcs.size());
+    target.resize(arcs.size());
+
+    for (auto& arc: arcs)
+    {
+        size_t p = pos[arc.from]++;
+        target[p] = arc.to;
+        weights[p] = arc.weight;
+    }
+
+    std::vector<Arc>().swap(arcs);
+    prob.resize(target.size());
+    alias.resize(target.size());
+
+    parallel_for(n, num_threads, [&](size_t v, size_t)
+    {
+        size_t k = start[v+1] - start[v];
+
+        if (k > 0)
+        {
+            build_alias(&weights[start[v]], k, &prob[start[v]], &alias[start[v]]);
+        }
+    }, 1024);
+}
+
+}
+
+WalkGraph
+build_walk_graph(
+    const uu::net::MultilayerNetwork* mnet,
+    const std::string& weight,
+    bool interlayer,
+    const std::vector<double>& switching,
+    size_t num_threads
+)
+{
+    std::vector<const uu::net::Network*> layers;
+    std::vector<size_t> offset;
+    size_t n = 0;
+
+    for (auto layer: *mnet->layers())
+    {
+        layers.push_back(layer);
+        offset.push_back(n);
+        n += layer->vertices()->size();
+    }
+
+    size_t L = layers.size();
+    std::vector<Arc> arcs;
+
+    // arcs with weight 0 cannot be traversed, and are not stored
+    auto add = [&](int from, int to, double w, bool directed)
+    {
+        if (w > 0)
+        {
+            arcs.push_back(Arc {from, to, w});
+
+            if (!directed && from != to)
+            {
+                arcs.push_back(Arc {to, from, w});
+            }
+        }
+    };
+
+    for (size_t l = 0; l < L; l++)
+    {
+        auto vertices = layers[l]->vertices();
+        auto attributes = layers[l]->edges()->attr();
+        bool weighted = has_weights(attributes, weight);
+
+        for (auto edge: *layers[l]->edges())
+        {
+            double w = weighted ? check_weight(attributes->get_double(edge, weight)) : 1;
+            add(offset[l] + vertices->index_of(edge->v1), offset[l] + vertices->index_of(edge->v2), w,
+                edge->dir == uu::net::EdgeDir::DIRECTED);
+        }
+    }
+
+    if (interlayer)
+    {
+        auto attributes = mnet->interlayer_edges()->attr();
+        bool weighted = has_weights(attributes, weight);
+
+        // as in edges_idx_ml(): the first vertex of an edge returned by get(l1,l2) is on l1
+        for (size_t i = 0; i < L; i++)
+        {
+            for (size_t j = 0; j < L; j++)
+            {
+                if (layers[j] <= layers[i])
+                {
+                    continue;
+                }
+
+                auto edges = mnet->interlayer_edges()->get(layers[i], layers[j]);
+
+                if (!edges)
+                {
+                    continue;
+                }
+
+                for (auto edge: *edges)
+                {
+                    int v1 = layers[i]->vertices()->index_of(edge->v1);
+                    int v2 = layers[j]->vertices()->index_of(edge->v2);
+
+                    if (v1 < 0 || v2 < 0)
+                    {
+                        continue;
+                    }
+
+                    double w = weighted ? check_weight(attributes->get_double(edge, weight)) : 1;
+                    add(offset[i] + v1, offset[j] + v2, w, edge->dir == uu::net::EdgeDir::DIRECTED);
+                }
+            }
+        }
+    }
+
+    WalkGraph g;
+    build_tables(arcs, n, num_threads, g.start, g.target, g.prob, g.alias);
+
+    if (switching.empty())
+    {
+        return g;
+    }
+
+    // layer switching: arcs between the vertices of each actor
+
+    if (switching.size() != L * L)
+    {
+        throw uu::core::WrongParameterException("the switching matrix must have one row and one column for each layer");
+    }
+
+    for (auto p: switching)
+    {
+        if (!(p >= 0) || std::isinf(p))
+        {
+            throw uu::core::WrongParameterException("switching probabilities must be non-negative numbers");
+        }
+    }
+
+    std::unordered_map<const uu::net::Vertex*, std::vector<std::pair<size_t, int>>> copies;
+
+    for (size_t l = 0; l < L; l++)
+    {
+        int v = 0;
+
+        for (auto actor: *layers[l]->vertices())
+        {
+            copies[actor].push_back(std::make_pair(l, offset[l] + v++));
+        }
+    }
+
+    for (size_t l = 0; l < L; l++)
+    {
+        int v = 0;
+
+        for (auto actor: *layers[l]->vertices())
+        {
+            size_t num_arcs = arcs.size();
+            int from = offset[l] + v++;
+
+            for (auto& copy: copies.at(actor))
+            {
+                add(from, copy.second, switching[l * L + copy.first], true);
+            }
+
+            // no possible switch: the walker stays on its layer
+            if (arcs.size() == num_arcs)
+            {
+                add(from, from, 1, true);
+            }
+        }
+    }
+
+    build_tables(arcs, n, num_threads, g.switch_start, g.switch_target, g.switch_prob, g.switch_alias);
+
+    return g;
+}
+
+void
+random_walks(
+    const WalkGraph& g,
+    const std::vector<int>& starts,
+    size_t walks_per_start,
+    size_t length,
+    uint64_t seed,
+    size_t num_threads,
+    int* out
+)
+{
+    size_t num_walks = starts.size() * walks_per_start;
+    bool switching = !g.switch_start.empty();
+
+    parallel_for(num_walks, num_threads, [&](size_t i, size_t)
+    {
+        SplitMix64 rng(seed ^ SplitMix64(i).next());
+        int v = starts[i / walks_per_start];
+        out[i] = v;
+
+        for (size_t step = 1; step <= length; step++)
+        {
+            if (v >= 0 && switching)
+            {
+                size_t s = g.switch_start[v];
+                v = g.switch_target[s + sample_alias(rng, &g.switch_prob[s], &g.switch_alias[s], g.switch_start[v+1] - s)];
+            }
+
+            if (v >= 0)
+            {
+                size_t s = g.start[v];
+                size_t k = g.start[v+1] - s;
+                v = k == 0 ? -1 : g.target[s + sample_alias(rng, &g.prob[s], &g.alias[s], k)];
+            }
+
+            out[i + step * num_walks] = v;
+        }
+    }, 256);
+}
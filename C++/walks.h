@@ -0,0 +1,82 @@
+#ifndef UU_R_MULTINET_WALKS_H_
+#define UU_R_MULTINET_WALKS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "networks/MultilayerNetwork.hpp"
+
+/**
+ * Weighted transitions of a random walker between the vertices of a multilayer network,
+ * stored as alias tables so that each step is sampled in constant time.
+ *
+ * Vertices are identified by their global position (layers in order, vertices in the
+ * order of each layer), the same used by vertices_ml() and edges_idx_ml().
+ */
+struct WalkGraph
+{
+    // outgoing edges of each vertex (intralayer and interlayer), with alias tables
+    // built from the edge weights
+    std::vector<size_t> start;
+    std::vector<int> target;
+    std::vector<double> prob;
+    std::vector<int> alias;
+
+    // layer switching: other vertices of the same actor reachable from each vertex
+    // (including the vertex itself), with alias tables; empty if no switching
+    std::vector<size_t> switch_start;
+    std::vector<int> switch_target;
+    std::vector<double> switch_prob;
+    std::vector<int> switch_alias;
+
+    size_t
+    num_vertices(
+    ) const
+    {
+        return start.size() - 1;
+    }
+};
+
+/**
+ * Builds the transitions of mnet.
+ *
+ * Edges are weighted by the numeric attribute weight (if not empty; edges without a value,
+ * or on layers without the attribute, have weight 1). Undirected edges can be traversed in
+ * both directions, and interlayer edges are included only if interlayer is true.
+ * switching is an empty vector or a L*L row-major matrix, where element (l,l') is
+ * proportional to the probability of moving from the vertex of an actor on layer l
+ * to its vertex on layer l' before each step.
+ *
+ * @throw WrongParameterException if a weight is not a non-negative number
+ */
+WalkGraph
+build_walk_graph(
+    const uu::net::MultilayerNetwork* mnet,
+    const std::string& weight,
+    bool interlayer,
+    const std::vector<double>& switching,
+    size_t num_threads
+);
+
+/**
+ * Simulates walks_per_start walks of length steps from each start vertex, in parallel.
+ *
+ * Walk i (the walks from starts[0] first) is written in row i of out, a column-major
+ * matrix with starts.size()*walks_per_start rows and length+1 columns: the start vertex
+ * followed by the vertex reached after each step, or -1 after reaching a vertex without
+ * outgoing edges. Each walk uses its own random number stream derived from seed, so the
+ * walks do not depend on the number of threads.
+ */
+void
+random_walks(
+    const WalkGraph& g,
+    const std::vector<int>& starts,
+    size_t walks_per_start,
+    size_t length,
+    uint64_t seed,
+    size_t num_threads,
+    int* out
+);
+
+#endif